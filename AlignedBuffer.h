@@ -0,0 +1,46 @@
+// Cache-line aligned storage for pixel rows
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GENETICART_SSE2 1
+#endif
+
+// Rows start on a 64-byte boundary: one cache line, and a whole number of SSE/AVX/AVX-512 vectors
+static constexpr size_t PIXEL_ROW_ALIGN = 64;
+
+/**
+ * @brief std::allocator replacement that returns PIXEL_ROW_ALIGN-aligned blocks.
+ *
+ * Separate canvases never share a cache line, so threads rendering their own
+ * canvases (or adjacent row bands of one padded canvas) do not false-share.
+ */
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(PIXEL_ROW_ALIGN)));
+    }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(PIXEL_ROW_ALIGN)); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+// Row pitch in elements: width rounded up so every row is a whole number of aligned lines
+template <typename T>
+inline int alignedStride(int width) {
+    constexpr int perLine = static_cast<int>(PIXEL_ROW_ALIGN / sizeof(T));
+    static_assert(PIXEL_ROW_ALIGN % sizeof(T) == 0, "element size must divide the row alignment");
+    return (width + perLine - 1) / perLine * perLine;
+}
@@ -0,0 +1,257 @@
+// Binary snapshots of a GeneticAlgorithm run for checkpoint and resume
+#pragma once
+#include "GenomeIO.h"
+#include <vector>
+#include <string>
+#include <future>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Checkpoint file (little-endian, version 3):
+ *   "GACK", version, 15 int32 run parameters and counters, bestSeen (double),
+ *   RNG state (uint32 length + text), adaptive operator state (uint32 length +
+ *   text, empty when off), hill-climber state (uint32 slot count, 0 for the
+ *   population engines; then per slot its RNG state as uint32 length + text,
+ *   the int64 step count and one GADN record of the current genome), then one
+ *   GADN genome record per individual (see GenomeIO.h), fittest first.
+ *   Version 1 files lack the operator state and version 2 the climber state.
+ */
+static const char CHECKPOINT_MAGIC[4] = {'G', 'A', 'C', 'K'};
+static const uint32_t CHECKPOINT_VERSION = 3;
+
+// Where a hill climb stands between steps; empty slotRngStates when the run is not hill climbing
+struct ClimbState {
+    std::vector<std::string> slotRngStates; // one per candidate slot
+    long long step = 0;                     // steps taken, for the cooling schedule
+    Individual current;                     // the genome being climbed (the best so far is population[0])
+};
+
+struct CheckpointState {
+    // Run parameters
+    int populationSize = 0;
+    int tournamentSize = 0;
+    int elitismCount = 0;
+    int imgWidth = 0;
+    int imgHeight = 0;
+    int minGeneSize = 0;
+    int maxGeneSize = 0;
+    int generations = 0;
+    ShapeType shapeType = ShapeType::Circle;
+    BlendMode blendMode = BlendMode::AlphaOver;
+
+    // Progress
+    int nextGeneration = 0;
+    int currentLevel = 0;
+    int levelStart = 0;
+    int lastImprovement = 0;
+    double bestSeen = 0.0;
+    std::string rngState;
+    std::string operatorState; // OperatorScheduler::saveState(); empty when scheduling is not adaptive
+    ClimbState climb;
+    std::vector<Individual> population;
+};
+
+inline std::vector<uint8_t> encodeCheckpoint(const CheckpointState& s) {
+    std::vector<uint8_t> out(4 + 4 + 15 * 4 + 8 + 4);
+    const uint32_t operatorSize = static_cast<uint32_t>(s.operatorState.size());
+    uint8_t* p = out.data();
+    std::memcpy(p, CHECKPOINT_MAGIC, 4);
+    genome_put32(p + 4, CHECKPOINT_VERSION);
+    const int fields[15] = {s.populationSize, s.tournamentSize, s.elitismCount, s.imgWidth, s.imgHeight, s.minGeneSize, s.maxGeneSize,
+                            s.generations, static_cast<int>(s.shapeType), static_cast<int>(s.blendMode), s.nextGeneration, s.currentLevel,
+                            s.levelStart, s.lastImprovement, static_cast<int>(s.population.size())};
+    for (int i = 0; i < 15; ++i) genome_put32(p + 8 + 4 * i, static_cast<uint32_t>(fields[i]));
+    uint64_t bits;
+    std::memcpy(&bits, &s.bestSeen, sizeof(bits));
+    genome_put32(p + 68, static_cast<uint32_t>(bits));
+    genome_put32(p + 72, static_cast<uint32_t>(bits >> 32));
+    genome_put32(p + 76, static_cast<uint32_t>(s.rngState.size()));
+
+    std::vector<uint8_t> climb(4);
+    genome_put32(climb.data(), static_cast<uint32_t>(s.climb.slotRngStates.size()));
+    if (!s.climb.slotRngStates.empty()) {
+        for (const auto& state : s.climb.slotRngStates) {
+            size_t at = climb.size();
+            climb.resize(at + 4 + state.size());
+            genome_put32(climb.data() + at, static_cast<uint32_t>(state.size()));
+            std::memcpy(climb.data() + at + 4, state.data(), state.size());
+        }
+        size_t at = climb.size();
+        climb.resize(at + 8);
+        genome_put32(climb.data() + at, static_cast<uint32_t>(static_cast<uint64_t>(s.climb.step)));
+        genome_put32(climb.data() + at + 4, static_cast<uint32_t>(static_cast<uint64_t>(s.climb.step) >> 32));
+        std::vector<uint8_t> current = encodeGenome(s.climb.current, s.imgWidth, s.imgHeight, s.blendMode);
+        climb.insert(climb.end(), current.begin(), current.end());
+    }
+
+    // Grow once and copy in place, like the fixed fields above
+    std::vector<std::vector<uint8_t>> genomes;
+    size_t size = out.size() + s.rngState.size() + 4 + operatorSize + climb.size();
+    for (const auto& individual : s.population) {
+        genomes.push_back(encodeGenome(individual, s.imgWidth, s.imgHeight, s.blendMode));
+        size += genomes.back().size();
+    }
+    size_t off = out.size();
+    out.resize(size);
+    std::memcpy(out.data() + off, s.rngState.data(), s.rngState.size());
+    off += s.rngState.size();
+    genome_put32(out.data() + off, operatorSize);
+    std::memcpy(out.data() + off + 4, s.operatorState.data(), operatorSize);
+    off += 4 + operatorSize;
+    std::memcpy(out.data() + off, climb.data(), climb.size());
+    off += climb.size();
+    for (const auto& genome : genomes) {
+        std::memcpy(out.data() + off, genome.data(), genome.size());
+        off += genome.size();
+    }
+    return out;
+}
+
+inline bool decodeCheckpoint(const std::vector<uint8_t>& data, CheckpointState& s) {
+    const size_t fixed = 4 + 4 + 15 * 4 + 8;
+    if (data.size() < fixed + 4 || std::memcmp(data.data(), CHECKPOINT_MAGIC, 4) != 0) return false;
+    const uint32_t version = genome_get32(data.data() + 4);
+    if (version < 1 || version > CHECKPOINT_VERSION) return false;
+    const uint8_t* p = data.data();
+    int fields[15];
+    for (int i = 0; i < 15; ++i) fields[i] = static_cast<int>(genome_get32(p + 8 + 4 * i));
+    s.populationSize = fields[0];
+    s.tournamentSize = fields[1];
+    s.elitismCount = fields[2];
+    s.imgWidth = fields[3];
+    s.imgHeight = fields[4];
+    s.minGeneSize = fields[5];
+    s.maxGeneSize = fields[6];
+    s.generations = fields[7];
+    s.shapeType = static_cast<ShapeType>(fields[8]);
+    s.blendMode = static_cast<BlendMode>(fields[9]);
+    s.nextGeneration = fields[10];
+    s.currentLevel = fields[11];
+    s.levelStart = fields[12];
+    s.lastImprovement = fields[13];
+    const int count = fields[14];
+    uint64_t bits = genome_get32(p + 68) | (static_cast<uint64_t>(genome_get32(p + 72)) << 32);
+    std::memcpy(&s.bestSeen, &bits, sizeof(bits));
+
+    size_t offset = fixed;
+    const size_t rngSize = genome_get32(p + offset);
+    offset += 4;
+    if (data.size() - offset < rngSize) return false;
+    s.rngState.assign(reinterpret_cast<const char*>(p + offset), rngSize);
+    offset += rngSize;
+    s.operatorState.clear();
+    if (version >= 2) {
+        if (data.size() - offset < 4) return false;
+        const size_t operatorSize = genome_get32(p + offset);
+        offset += 4;
+        if (data.size() - offset < operatorSize) return false;
+        s.operatorState.assign(reinterpret_cast<const char*>(p + offset), operatorSize);
+        offset += operatorSize;
+    }
+    s.climb = ClimbState();
+    if (version >= 3) {
+        if (data.size() - offset < 4) return false;
+        const size_t slots = genome_get32(p + offset);
+        offset += 4;
+        for (size_t i = 0; i < slots; ++i) {
+            if (data.size() - offset < 4) return false;
+            const size_t length = genome_get32(p + offset);
+            offset += 4;
+            if (data.size() - offset < length) return false;
+            s.climb.slotRngStates.emplace_back(reinterpret_cast<const char*>(p + offset), length);
+            offset += length;
+        }
+        if (slots > 0) {
+            if (data.size() - offset < 8) return false;
+            s.climb.step = static_cast<long long>(genome_get32(p + offset) | (static_cast<uint64_t>(genome_get32(p + offset + 4)) << 32));
+            offset += 8;
+            Genome current;
+            size_t used = decodeGenome(p + offset, data.size() - offset, current);
+            if (used == 0) return false;
+            s.climb.current = current.individual;
+            offset += used;
+        }
+    }
+
+    s.population.clear();
+    for (int i = 0; i < count; ++i) {
+        Genome genome;
+        size_t used = decodeGenome(p + offset, data.size() - offset, genome);
+        if (used == 0) return false;
+        s.population.push_back(genome.individual);
+        offset += used;
+    }
+    return count > 0;
+}
+
+// Writes to "<path>.tmp" and renames over path, so a crash never leaves a torn checkpoint.
+// On POSIX the data is synced before the rename and the directory entry after it, so a power
+// loss cannot leave the new name pointing at blocks that were never written.
+inline bool saveCheckpointAtomic(const std::string& path, const CheckpointState& state) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::vector<uint8_t> bytes = encodeCheckpoint(state);
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size() && std::fflush(f) == 0;
+#if !defined(_WIN32)
+        ok = ok && ::fsync(fileno(f)) == 0;
+#endif
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) return false;
+#if !defined(_WIN32)
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    const bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+#else
+    return true;
+#endif
+}
+
+inline bool loadCheckpoint(const std::string& path, CheckpointState& state) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return decodeCheckpoint(bytes, state);
+}
+
+/**
+ * @brief Encodes and writes checkpoints on a background thread, one at a time.
+ *
+ * The GA thread only copies the population (shared DNA ropes) into the state.
+ * A new submit waits for the previous write, so at most one is in flight.
+ */
+class CheckpointWriter {
+public:
+    ~CheckpointWriter() { wait(); }
+
+    void submit(std::string path, CheckpointState state) {
+        wait();
+        pending = std::async(std::launch::async, [path = std::move(path), state = std::move(state)]() {
+            return saveCheckpointAtomic(path, state);
+        });
+    }
+
+    // Result of the last write; true when nothing was pending
+    bool wait() {
+        if (!pending.valid()) return true;
+        return pending.get();
+    }
+
+private:
+    std::future<bool> pending;
+};
@@ -0,0 +1,131 @@
+// Summed-area table of per-pixel target error for O(1) rectangle queries
+#pragma once
+#include "Render.h"
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <atomic>
+
+/**
+ * @brief A rendered canvas together with its per-pixel error against the target
+ * and the integral image of that error. Canvas and target both have canvas
+ * layout (canvasStride(width) pixels per row).
+ *
+ * regionError() answers the L1 RGBA error of any rectangle with four lookups.
+ * After a mutation only the dirty rectangle is re-rendered and re-scored, but
+ * every integral entry below and to the right of its top-left corner depends
+ * on it. An update therefore costs (height - y0) x (width - x0) additions, not
+ * the dirty area. That is still far less than a full render for changes near
+ * the bottom-right, but up to the whole image for changes near the top-left.
+ */
+class ErrorTable {
+public:
+    ErrorTable(int width, int height, double scale, BlendMode mode, const Pixel32* target, PixelBuffer canvas)
+        : width(width), height(height), stride(canvasStride(width)), scale(scale), mode(mode), canvas(std::move(canvas)),
+          pixelError(static_cast<size_t>(width) * height),
+          integral(static_cast<size_t>(width + 1) * (height + 1), 0) {
+        rescore(target, Rect{0, 0, width - 1, height - 1});
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    double getScale() const { return scale; }
+    BlendMode getMode() const { return mode; }
+    const PixelBuffer& getCanvas() const { return canvas; }
+
+    // Error of the inclusive canvas rectangle r, clipped to the table
+    uint64_t regionError(const Rect& r) const {
+        Rect c = r.clipped(width, height);
+        if (c.empty()) return 0;
+        return at(c.x1 + 1, c.y1 + 1) - at(c.x0, c.y1 + 1) - at(c.x1 + 1, c.y0) + at(c.x0, c.y0);
+    }
+
+    uint64_t totalError() const { return at(width, height); }
+
+    // Error `region` (inside the table) would have with `pixels` (row-major, region-sized) in place of the canvas
+    uint64_t regionErrorWith(const Pixel32* target, const Rect& region, const Pixel32* pixels) const {
+        const size_t rw = static_cast<size_t>(region.x1 - region.x0 + 1);
+        uint64_t error = 0;
+        for (int y = region.y0; y <= region.y1; ++y) {
+            error += pixelAbsDiffSum(target + static_cast<size_t>(y) * stride + region.x0, pixels + static_cast<size_t>(y - region.y0) * rw, rw);
+        }
+        return error;
+    }
+
+    // Re-render `region` (canvas pixels) from the individual's DNA and refresh the table
+    void refresh(const Individual& individual, const Pixel32* target, const Rect& region) {
+        Rect c = region.clipped(width, height);
+        if (c.empty()) return;
+        renderIndividualRegion(width, height, individual, mode, c, canvas, scale);
+        rescore(target, c);
+    }
+
+    // Replace the pixels of `region` with `pixels` (row-major, region-sized) and refresh the table
+    void replaceRegion(const Pixel32* target, const Rect& region, const Pixel32* pixels) {
+        Rect c = region.clipped(width, height);
+        if (c.empty()) return;
+        int rw = region.x1 - region.x0 + 1;
+        for (int y = c.y0; y <= c.y1; ++y) {
+            for (int x = c.x0; x <= c.x1; ++x) {
+                canvas[static_cast<size_t>(y) * stride + x] = pixels[static_cast<size_t>(y - region.y0) * rw + (x - region.x0)];
+            }
+        }
+        rescore(target, c);
+    }
+
+private:
+    int width;
+    int height;
+    int stride;
+    double scale;
+    BlendMode mode;
+    PixelBuffer canvas;
+    std::vector<uint16_t> pixelError; // at most 4 * 255 per pixel
+    std::vector<uint64_t> integral;   // (width + 1) x (height + 1), first row and column are zero
+
+    uint64_t& at(int x, int y) { return integral[static_cast<size_t>(y) * (width + 1) + x]; }
+    uint64_t at(int x, int y) const { return integral[static_cast<size_t>(y) * (width + 1) + x]; }
+
+    void rescore(const Pixel32* target, const Rect& c) {
+        for (int y = c.y0; y <= c.y1; ++y) {
+            for (int x = c.x0; x <= c.x1; ++x) {
+                size_t i = static_cast<size_t>(y) * stride + x;
+                const Pixel32& o = target[i];
+                const Pixel32& p = canvas[i];
+                pixelError[static_cast<size_t>(y) * width + x] = static_cast<uint16_t>(std::abs(o.r - p.r) + std::abs(o.g - p.g) + std::abs(o.b - p.b) + std::abs(o.a - p.a));
+            }
+        }
+        // Every integral entry below and to the right of the change depends on it. Column c.x0 of
+        // the integral is left of the change, so it still holds each row's unchanged prefix sum.
+        for (int y = c.y0; y < height; ++y) {
+            uint64_t rowSum = at(c.x0, y + 1) - at(c.x0, y);
+            for (int x = c.x0; x < width; ++x) {
+                rowSum += pixelError[static_cast<size_t>(y) * width + x];
+                at(x + 1, y + 1) = at(x + 1, y) + rowSum;
+            }
+        }
+    }
+};
+
+// Exact L1 fitness through the individual's error table: a full render the first time (or when
+// the canvas no longer matches), otherwise only the region dirtied since the last call is redone.
+// A table shared with a parent or elite is cloned before it is modified.
+inline double scoreIndividualIncremental(int width, int height, const Pixel32* target, Individual& individual, BlendMode mode, double scale = 1.0) {
+    ErrorTable* table = individual.errorTable.get();
+    if (!table || table->getWidth() != width || table->getHeight() != height || table->getScale() != scale || table->getMode() != mode) {
+        individual.errorTable = std::make_shared<ErrorTable>(width, height, scale, mode, target, renderIndividualToPixels(width, height, individual, mode, scale));
+    } else {
+        Rect region = scaledRegion(individual.dirty, scale, width, height);
+        if (!region.empty()) {
+            if (individual.errorTable.use_count() > 1) {
+                individual.errorTable = std::make_shared<ErrorTable>(*table);
+            } else {
+                std::atomic_thread_fence(std::memory_order_acquire); // pairs with the release of the last other owner
+            }
+            individual.errorTable->refresh(individual, target, region);
+        }
+    }
+    individual.dirty = Rect::none();
+    return static_cast<double>(individual.errorTable->totalError());
+}
@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <memory>
 #include <algorithm>
+#include <climits>
 #include "RandomHelper.h"
 
 struct Color {
@@ -13,6 +14,23 @@ struct Position {
     int y;
 };
 
+// Inclusive pixel rectangle; empty when x1 < x0 or y1 < y0
+struct Rect {
+    int x0, y0, x1, y1;
+
+    static Rect none() { return Rect{0, 0, -1, -1}; }
+    bool empty() const { return x1 < x0 || y1 < y0; }
+    long long area() const { return empty() ? 0 : static_cast<long long>(x1 - x0 + 1) * (y1 - y0 + 1); }
+    Rect united(const Rect& o) const {
+        if (empty()) return o;
+        if (o.empty()) return *this;
+        return Rect{std::min(x0, o.x0), std::min(y0, o.y0), std::max(x1, o.x1), std::max(y1, o.y1)};
+    }
+    Rect clipped(int width, int height) const {
+        return Rect{std::max(0, x0), std::max(0, y0), std::min(width - 1, x1), std::min(height - 1, y1)};
+    }
+};
+
 // Shape selector to support multiple gene types
 enum class ShapeType {
     Circle,
@@ -28,6 +46,12 @@ public:
     int getLength() const { return length; }
     Color getColor() const { return color; }
     Position getPosition() const { return position; }
+    // Pixels the shape can touch at full resolution, before clipping to the image
+    Rect bounds() const {
+        int r = (type == ShapeType::Circle) ? length : length / 2;
+        return Rect{position.x - r, position.y - r, position.x + r, position.y + r};
+    }
+    void setLength(int value) { length = std::max(1, value); }
     Gene clone() const {
         return Gene(position.x, position.y, color, type, length);
     }
@@ -56,10 +80,10 @@ public:
         color.a = (color.a + rand.getInt(-10, 10)) % 256;
     }
 
-    void mutateLength(Random& rand) {
-        // Change length by max 20% of current length
-        int delta = length * 0.2;
-        length = std::max(1, length + rand.getInt(-delta, delta));
+    void mutateLength(Random& rand, int maxLength = INT_MAX) {
+        // Change length by max 20% of current length (at least 1, so small genes can still grow)
+        int delta = std::max(1, static_cast<int>(length * 0.2));
+        length = std::clamp(length + rand.getInt(-delta, delta), 1, std::max(1, maxLength));
     }
 
     
@@ -0,0 +1,179 @@
+// Persistent DNA storage: a rope of reference-counted gene chunks
+#pragma once
+#include "Gene.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <atomic>
+
+/**
+ * @brief Sequence of genes stored as shared, fixed-capacity chunks.
+ *
+ * Copying a rope copies only the chunk pointers, so children, elites and
+ * tournament winners share every gene they did not change with their parents.
+ * A chunk is cloned the first time a shared copy writes to it (copy-on-write).
+ * Mutation happens on one thread per rope; concurrent readers are fine.
+ */
+class GeneRope {
+public:
+    static constexpr size_t ChunkSize = 64;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Gene;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Gene*;
+        using reference = const Gene&;
+
+        const_iterator() : rope(nullptr), chunk(0), offset(0) {}
+        const_iterator(const GeneRope* rope, size_t chunk, size_t offset) : rope(rope), chunk(chunk), offset(offset) {}
+
+        reference operator*() const { return (*rope->chunks[chunk])[offset]; }
+        pointer operator->() const { return &**this; }
+        const_iterator& operator++() {
+            if (++offset == rope->chunks[chunk]->size()) {
+                ++chunk;
+                offset = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) { const_iterator tmp = *this; ++*this; return tmp; }
+        bool operator==(const const_iterator& o) const { return chunk == o.chunk && offset == o.offset; }
+        bool operator!=(const const_iterator& o) const { return !(*this == o); }
+
+    private:
+        const GeneRope* rope;
+        size_t chunk;
+        size_t offset;
+    };
+
+    size_t size() const { return ends.empty() ? 0 : ends.back(); }
+    bool empty() const { return size() == 0; }
+    size_t chunkCount() const { return chunks.size(); }
+
+    const_iterator begin() const { return const_iterator(this, 0, 0); }
+    const_iterator end() const { return const_iterator(this, chunks.size(), 0); }
+    const_iterator iteratorAt(size_t index) const {
+        if (index >= size()) return end();
+        size_t offset;
+        size_t c = locate(index, offset);
+        return const_iterator(this, c, offset);
+    }
+
+    const Gene& operator[](size_t index) const {
+        size_t offset;
+        size_t c = locate(index, offset);
+        return (*chunks[c])[offset];
+    }
+
+    // Writable access; clones the chunk first if another rope still shares it
+    Gene& mutableAt(size_t index) {
+        size_t offset;
+        size_t c = locate(index, offset);
+        return ownChunk(c)[offset];
+    }
+
+    void push_back(const Gene& gene) {
+        if (chunks.empty() || chunks.back()->size() >= ChunkSize) {
+            chunks.push_back(std::make_shared<Chunk>());
+            chunks.back()->reserve(ChunkSize);
+            ends.push_back(size());
+        }
+        ownChunk(chunks.size() - 1).push_back(gene);
+        ++ends.back();
+    }
+
+    void erase(size_t index) {
+        size_t offset;
+        size_t c = locate(index, offset);
+        Chunk& chunk = ownChunk(c);
+        chunk.erase(chunk.begin() + offset);
+        if (chunk.empty()) {
+            chunks.erase(chunks.begin() + c);
+        } else if (chunk.size() < ChunkSize / 4) {
+            // Keep erase-heavy lineages from fragmenting into tiny chunks
+            if (c + 1 < chunks.size() && chunk.size() + chunks[c + 1]->size() <= ChunkSize) mergeWithNext(c);
+            else if (c > 0 && chunk.size() + chunks[c - 1]->size() <= ChunkSize) mergeWithNext(c - 1);
+        }
+        rebuildEnds();
+    }
+
+    // Genes [first, last) as a new rope; whole chunks are shared, partial ends are copied
+    GeneRope slice(size_t first, size_t last) const {
+        GeneRope out;
+        last = std::min(last, size());
+        if (first >= last) return out;
+        size_t offset;
+        size_t c = locate(first, offset);
+        size_t chunkStart = first - offset;
+        for (; c < chunks.size() && chunkStart < last; ++c) {
+            size_t chunkEnd = ends[c];
+            size_t from = std::max(first, chunkStart) - chunkStart;
+            size_t to = std::min(last, chunkEnd) - chunkStart;
+            if (from == 0 && to == chunks[c]->size()) {
+                out.appendChunk(chunks[c]);
+            } else {
+                out.appendChunk(std::make_shared<Chunk>(chunks[c]->begin() + from, chunks[c]->begin() + to));
+            }
+            chunkStart = chunkEnd;
+        }
+        return out;
+    }
+
+    void append(const GeneRope& other) {
+        for (const auto& chunk : other.chunks) appendChunk(chunk);
+    }
+
+private:
+    using Chunk = std::vector<Gene>;
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    std::vector<size_t> ends; // ends[c] = index one past the last gene of chunk c
+
+    size_t locate(size_t index, size_t& offset) const {
+        size_t c = std::upper_bound(ends.begin(), ends.end(), index) - ends.begin();
+        offset = index - (c == 0 ? 0 : ends[c - 1]);
+        return c;
+    }
+
+    Chunk& ownChunk(size_t c) {
+        if (chunks[c].use_count() > 1) {
+            chunks[c] = std::make_shared<Chunk>(*chunks[c]);
+        } else {
+            // Another thread (e.g. the snapshot writer) may have just released its copy
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *chunks[c];
+    }
+
+    void appendChunk(std::shared_ptr<Chunk> chunk) {
+        // Two half-empty chunks meeting at a crossover point are merged into one fresh chunk
+        if (!chunks.empty() && chunks.back()->size() < ChunkSize / 2 && chunk->size() < ChunkSize / 2) {
+            auto merged = std::make_shared<Chunk>(*chunks.back());
+            merged->insert(merged->end(), chunk->begin(), chunk->end());
+            chunks.back() = std::move(merged);
+            ends.back() += chunk->size();
+            return;
+        }
+        ends.push_back(size() + chunk->size());
+        chunks.push_back(std::move(chunk));
+    }
+
+    void mergeWithNext(size_t c) {
+        auto merged = std::make_shared<Chunk>(*chunks[c]);
+        merged->insert(merged->end(), chunks[c + 1]->begin(), chunks[c + 1]->end());
+        chunks[c] = std::move(merged);
+        chunks.erase(chunks.begin() + c + 1);
+    }
+
+    void rebuildEnds() {
+        ends.resize(chunks.size());
+        size_t total = 0;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            total += chunks[c]->size();
+            ends[c] = total;
+        }
+    }
+};
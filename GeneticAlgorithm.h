@@ -1,52 +1,256 @@
+#pragma once
 #include "Individual.h"
-#include "Draw.h"
+#include "Render.h"
+#include "Pyramid.h"
+#include "ErrorTable.h"
+#include "ThreadPool.h"
+#include "SnapshotWriter.h"
+#include "Checkpoint.h"
+#include "Profile.h"
+#include "Migration.h"
+#include "RemoteEvaluation.h"
+#include "OperatorScheduler.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <cmath>
+#include <functional>
+
+struct GeneticAlgorithmOptions
+{
+    // Coarse-to-fine schedule: early generations evolve against downsampled copies of the target.
+    int pyramidLevels = 0;          // coarser levels below full resolution (0 = always full resolution)
+    int generationsPerLevel = 0;    // promote to the next finer level after this many generations (0 = half the run over the levels)
+    int stagnationGenerations = 0;  // also promote after this many generations without improvement
+    const std::vector<PyramidLevel>* pyramid = nullptr; // prebuilt levels (e.g. loadTargetPyramid); nullptr builds them
+
+    // Estimated fitness: rank children on a stratified random subset of pixels, refreshed every
+    // generation, and re-score only the best candidates exactly before they become elites.
+    int fitnessSamples = 0;         // pixels scored per individual (0 = exact full-resolution scoring)
+    int exactFinalists = 0;         // candidates re-scored exactly on top of elitismCount
+
+    // Keep a composited canvas every N genes per individual so children repaint only from the
+    // first changed gene onward (0 = always render from gene 0). Costs one canvas per checkpoint.
+    int checkpointInterval = 0;
+
+    // Keep each individual's canvas and summed-area error table; children re-render and re-score
+    // only the region covered by genes that differ from parent1 or were mutated.
+    bool errorTables = false;
+
+    // Render cost bound: total full-resolution pixels an individual's genes may cover (0 = no bound).
+    // Initialization and mutation shrink the costliest genes to fit; anything still over budget
+    // (e.g. a genome resumed from a checkpoint) is not rendered and scores worse than any real image.
+    uint64_t pixelBudget = 0;
+    double areaBudget = 0.0;        // same bound in multiples of the image area, used when pixelBudget is 0
+
+    // Gene length (circle radius, square side) bounds for new genes and length mutations, sampled
+    // log-uniformly. Independent of the gene-count bounds passed to the constructor.
+    int minGeneLength = 1;
+    int maxGeneLength = 0;          // 0 = a quarter of the smaller image side
+
+    // Steady-state (mu+lambda) engine instead of generations: every thread keeps breeding, scoring
+    // and inserting single children with no barrier between them (see runSteadyState). Scores at
+    // full resolution, so the pyramid and sampled-fitness options do not apply.
+    bool steadyState = false;
+
+    // Single-genome (1+lambda) hill climbing instead of a population (see runHillClimb): each step
+    // mutates the best individual climbCandidates ways and scores only the changed rectangles
+    // against one cached canvas. Worse candidates are accepted with probability exp(-delta / T)
+    // while T cools linearly from `temperature` (fitness units) to 0. Full resolution, like steadyState.
+    bool hillClimb = false;
+    int climbCandidates = 0;        // lambda; 0 = one per pool thread
+    double temperature = 0.0;       // 0 = accept improvements (and ties) only
+
+    // Choose mutation operators (gene position, color, length, add, delete) by their measured
+    // improvement per pixel of scoring work instead of fixed odds (see OperatorScheduler.h)
+    bool adaptiveOperators = false;
+
+    // Island model (see Islands.h): every migrationInterval generations, copies of this island's
+    // `migrants` best individuals go to its topology neighbours and arrivals replace the worst
+    MigrationChannel* migration = nullptr;   // nullptr = a single population
+    int island = 0;
+    int migrationInterval = 0;
+    int migrants = 1;
+    MigrationTopology topology = MigrationTopology::Ring;
+
+    // Distributed evaluation (see RemoteEvaluation.h): whole generations are scored exactly on
+    // worker processes holding the same target. Ignored with fitnessSamples, errorTables or steadyState,
+    // whose scoring state lives with the individuals.
+    RemoteEvaluator* remote = nullptr;
+
+    // Run control
+    unsigned int seed = 0;                   // 0 = non-deterministic seed
+    std::string outputDirectory = "./images"; // generation snapshots are written here
+    int snapshotEvery = 100;                 // generations between snapshots (0 = none)
+    int snapshotQueueDepth = 4;              // pending snapshots before the GA waits for the writer
+    std::string snapshotFormat = "tga";      // tga, png, ppm or pam
+    ThreadPool* pool = nullptr;              // shared workers; nullptr spawns threads per evaluation
+    // Called after every generation with its 1-based number and the current best (e.g. for benchmarks)
+    std::function<void(int generation, const Individual& best)> onGeneration;
+
+    // Periodic checkpoints of the whole run, written atomically in the background
+    std::string checkpointPath;              // empty = no checkpoints
+    int checkpointEvery = 0;                 // generations between checkpoints
+};
 
 class GeneticAlgorithm
 {
 public:
 
-    GeneticAlgorithm(int populationSize, int tsSize, int elitismCount, int imgWidth, int imgHeight, std::vector<Pixel32> originalPixels, int minGeneSize, int maxGeneSize, int generations, ShapeType shapeType, BlendMode blendMode = BlendMode::AlphaOver)
+    GeneticAlgorithm(int populationSize, int tsSize, int elitismCount, int imgWidth, int imgHeight, const Image& target, int minGeneSize, int maxGeneSize, int generations, ShapeType shapeType, BlendMode blendMode = BlendMode::AlphaOver, const GeneticAlgorithmOptions& options = GeneticAlgorithmOptions())
     {
         this->populationSize = populationSize;
         this->imgWidth = imgWidth;
         this->imgHeight = imgHeight;
-        this->originalPixels = originalPixels;
+        this->pyramid = pyramidFor(target, options);
+        this->options = options;
         this->minGeneSize = minGeneSize;
         this->maxGeneSize = maxGeneSize;
+        resolveGeneBounds();
         this->generations = generations;
         this->shapeType = shapeType;
         this->blendMode = blendMode;
         this->tournamentSize = tsSize;
         this->elitismCount = elitismCount;
+        if (options.seed != 0) {
+            this->rand.seed(options.seed);
+        }
+        if (options.snapshotEvery > 0) {
+            snapshotWriter = std::make_unique<SnapshotWriter>(options.snapshotQueueDepth);
+        }
 
         evolve();
 
         
 
 
+    }
+
+    // Resume constructor: continues the run saved at checkpointPath. Run parameters come from
+    // the checkpoint; options (including where to keep checkpointing) come from the caller.
+    GeneticAlgorithm(const std::string& checkpointPath, const Image& target, const GeneticAlgorithmOptions& options = GeneticAlgorithmOptions())
+    {
+        CheckpointState state;
+        if (!loadCheckpoint(checkpointPath, state)) {
+            throw std::runtime_error("Failed to load checkpoint " + checkpointPath);
+        }
+        if (target.width != state.imgWidth || target.height != state.imgHeight) {
+            throw std::runtime_error("Checkpoint " + checkpointPath + " was made for a different image size");
+        }
+        this->populationSize = state.populationSize;
+        this->imgWidth = state.imgWidth;
+        this->imgHeight = state.imgHeight;
+        this->pyramid = pyramidFor(target, options);
+        this->options = options;
+        this->minGeneSize = state.minGeneSize;
+        this->maxGeneSize = state.maxGeneSize;
+        resolveGeneBounds();
+        this->generations = state.generations;
+        this->shapeType = state.shapeType;
+        this->blendMode = state.blendMode;
+        this->tournamentSize = state.tournamentSize;
+        this->elitismCount = state.elitismCount;
+        if (!rand.restoreState(state.rngState)) {
+            throw std::runtime_error("Corrupt RNG state in checkpoint " + checkpointPath);
+        }
+        // Checkpoints from non-adaptive runs (or version 1) carry none: the schedule starts over
+        if (options.adaptiveOperators && !state.operatorState.empty() && !operators.restoreState(state.operatorState)) {
+            throw std::runtime_error("Corrupt operator state in checkpoint " + checkpointPath);
+        }
+        if (options.snapshotEvery > 0) {
+            snapshotWriter = std::make_unique<SnapshotWriter>(options.snapshotQueueDepth);
+        }
+
+        population = std::move(state.population);
+        resumedClimb = std::move(state.climb);
+        currentLevel = std::min(state.currentLevel, static_cast<int>(pyramid.size()) - 1);
+        levelStart = state.levelStart;
+        lastImprovement = state.lastImprovement;
+        bestSeen = state.bestSeen;
+        std::cout << "Resuming at generation " << state.nextGeneration + 1 << " of " << generations << std::endl;
+        runGenerations(state.nextGeneration);
+    }
+
+    // The caller's prebuilt levels when they match the target, else a freshly built pyramid
+    static std::vector<PyramidLevel> pyramidFor(const Image& target, const GeneticAlgorithmOptions& options)
+    {
+        const std::vector<PyramidLevel>* prebuilt = options.pyramid;
+        if (prebuilt && !prebuilt->empty() && (*prebuilt)[0].width == target.width && (*prebuilt)[0].height == target.height
+            && (*prebuilt)[0].canvasLayout()) {
+            size_t levels = std::min(prebuilt->size(), static_cast<size_t>(std::max(0, options.pyramidLevels)) + 1);
+            return std::vector<PyramidLevel>(prebuilt->begin(), prebuilt->begin() + levels);
+        }
+        return buildPyramid(target, options.pyramidLevels);
     }
 
     void evolve()
     {
+        currentLevel = options.steadyState || options.hillClimb ? 0 : static_cast<int>(pyramid.size()) - 1;
         initializePopulation();
         evaluateFitness();
 
-        for (int gen = 0; gen < generations; ++gen) {
-            
+        levelStart = 0;
+        lastImprovement = 0;
+        bestSeen = population[0].fitness;
+        runGenerations(0);
+    }
+
+    void runGenerations(int firstGeneration)
+    {
+        if (options.steadyState) {
+            runSteadyState(firstGeneration);
+            finishRun();
+            return;
+        }
+        if (options.hillClimb) {
+            runHillClimb(firstGeneration);
+            finishRun();
+            return;
+        }
+        for (int gen = firstGeneration; gen < generations; ++gen) {
+            GA_PROFILE_SCOPE("generation");
             selection();
             mutation();
             applyElitism();
             evaluateFitness();
 
-            std::cout << "Generation " << gen + 1 << ". Best fitness: " << population[0].fitness << " with " << population[0].dna.size() << " genes." << std::endl;
+            std::cout << "Generation " << gen + 1 << ". Best fitness: " << population[0].fitness;
+            if (population[0].fitnessInterval > 0.0) std::cout << " +/- " << population[0].fitnessInterval;
+            std::cout << " with " << population[0].dna.size() << " genes covering " << pixelCost(population[0]) << " px." << std::endl;
+
+            if (population[0].fitness < bestSeen) {
+                bestSeen = population[0].fitness;
+                lastImprovement = gen;
+            }
+            if (currentLevel > 0 && shouldPromote(gen - levelStart + 1, gen - lastImprovement)) {
+                --currentLevel;
+                std::cout << "Promoting to pyramid level " << currentLevel << " (" << pyramid[currentLevel].width << "x" << pyramid[currentLevel].height << ")" << std::endl;
+                evaluateFitness();
+                levelStart = gen + 1;
+                lastImprovement = gen;
+                bestSeen = population[0].fitness;
+            }
+            if (migrationDue(gen)) {
+                migrate();
+            }
+            if (options.onGeneration) {
+                options.onGeneration(gen + 1, population[0]);
+            }
             
-            if(gen % 100 == 0){
-                drawPixels(imgWidth, imgHeight, renderIndividualToPixels(imgWidth, imgHeight, population[0], blendMode), "./images/Generation " + std::to_string(gen + 1) + ".tga", false);
+            if(options.snapshotEvery > 0 && gen % options.snapshotEvery == 0){
+                GA_PROFILE_SCOPE("snapshot");
+                snapshotWriter->submit(population[0], imgWidth, imgHeight, blendMode, options.outputDirectory + "/Generation " + std::to_string(gen + 1) + "." + options.snapshotFormat);
+            }
+            if (!options.checkpointPath.empty() && options.checkpointEvery > 0 && (gen + 1) % options.checkpointEvery == 0) {
+                GA_PROFILE_SCOPE("checkpoint");
+                checkpointWriter.submit(options.checkpointPath, checkpointState(gen + 1));
             }
         }
+        finishRun();
     }
 
 
@@ -55,50 +259,140 @@ public:
         return population[0];
     }
 
+    // Pixels a full-resolution render of the individual blends: the cost model pixelBudget bounds
+    uint64_t pixelCost(const Individual& individual) const
+    {
+        return individualPixelCost(individual, imgWidth, imgHeight);
+    }
+
 
 private:
+    friend struct GeneticAlgorithmBenchAccess; // bench/ drives individual phases
+
     int populationSize;
     int imgWidth;
     int imgHeight;
-    int minGeneSize;
+    int minGeneSize;          // initial gene count bounds
     int maxGeneSize;
+    int minGeneLength = 1;    // gene length bounds, resolved from options against the image size
+    int maxGeneLength = 1;
+    uint64_t pixelBudget = 0; // resolved options.pixelBudget / areaBudget; 0 = unbounded
     int generations;
     int tournamentSize;
     int elitismCount;
     ShapeType shapeType;
     BlendMode blendMode;
-    std::vector<Pixel32> originalPixels;
+    GeneticAlgorithmOptions options;
+    std::vector<PyramidLevel> pyramid; // pyramid[0] is the full-resolution target
+    int currentLevel = 0;
+    int levelStart = 0;       // generation the current pyramid level started at
+    int lastImprovement = 0;  // last generation that improved bestSeen
+    double bestSeen = 0.0;
+
+    std::vector<Position> samplePoints; // grouped by stratum, samplesPerStratum each
+    std::vector<double> stratumArea;
+    int samplesPerStratum = 0;
 
     std::vector<Individual> population;
     std::vector<Individual> elite;
 
     Random rand;
     std::mutex cout_mutex;
+    std::unique_ptr<SnapshotWriter> snapshotWriter;
+    OperatorScheduler operators; // used with options.adaptiveOperators
+    CheckpointWriter checkpointWriter;
+    ClimbState resumedClimb; // hill-climber state from the checkpoint being resumed, if any
+
+    // Everything needed to continue after `nextGeneration` generations have run
+    CheckpointState checkpointState(int nextGeneration) const {
+        CheckpointState state;
+        state.populationSize = populationSize;
+        state.tournamentSize = tournamentSize;
+        state.elitismCount = elitismCount;
+        state.imgWidth = imgWidth;
+        state.imgHeight = imgHeight;
+        state.minGeneSize = minGeneSize;
+        state.maxGeneSize = maxGeneSize;
+        state.generations = generations;
+        state.shapeType = shapeType;
+        state.blendMode = blendMode;
+        state.nextGeneration = nextGeneration;
+        state.currentLevel = currentLevel;
+        state.levelStart = levelStart;
+        state.lastImprovement = lastImprovement;
+        state.bestSeen = bestSeen;
+        state.rngState = rand.saveState();
+        if (options.adaptiveOperators) state.operatorState = operators.saveState();
+        state.population = population;
+        return state;
+    }
     
+    void resolveGeneBounds() {
+        maxGeneLength = options.maxGeneLength > 0 ? options.maxGeneLength : std::max(1, std::min(imgWidth, imgHeight) / 4);
+        minGeneLength = std::clamp(options.minGeneLength, 1, maxGeneLength);
+        pixelBudget = options.pixelBudget > 0 ? options.pixelBudget
+                                              : static_cast<uint64_t>(std::max(0.0, options.areaBudget) * imgWidth * imgHeight);
+    }
+
     void initializePopulation(){
         for (int i = 0; i < populationSize; ++i) {
             Individual individual;
-            for (int j = 0; j < rand.getInt(minGeneSize, maxGeneSize); ++j) {
-                individual.add_random_gene(rand, imgWidth, imgHeight, maxGeneSize, shapeType);
+            const int genes = rand.getInt(minGeneSize, maxGeneSize);
+            for (int j = 0; j < genes; ++j) {
+                individual.add_random_gene(rand, imgWidth, imgHeight, minGeneLength, maxGeneLength, shapeType);
             }
+            fitPixelBudget(individual);
             population.push_back(individual);
         }
     }
 
-    void evaluateFitness() {
+    // Halves the costliest gene (dropping genes already at length 1) until the individual's
+    // full-resolution render fits pixelBudget. Returns whether anything changed.
+    bool fitPixelBudget(Individual& individual) {
+        if (pixelBudget == 0) return false;
+        std::vector<uint64_t> costs;
+        costs.reserve(individual.dna.size());
+        uint64_t total = 0;
+        for (const auto& g : individual.dna) {
+            costs.push_back(genePixelCost(g, imgWidth, imgHeight));
+            total += costs.back();
+        }
+        bool changed = false;
+        while (total > pixelBudget && !costs.empty()) {
+            const size_t worst = static_cast<size_t>(std::max_element(costs.begin(), costs.end()) - costs.begin());
+            total -= costs[worst];
+            const int length = individual.dna[worst].getLength();
+            if (length > 1) {
+                individual.set_gene_length(worst, length / 2);
+                costs[worst] = genePixelCost(individual.dna[worst], imgWidth, imgHeight);
+                total += costs[worst];
+            } else {
+                individual.delete_gene(worst);
+                costs.erase(costs.begin() + worst);
+            }
+            changed = true;
+        }
+        return changed;
+    }
+
+    // Runs fn(population[i]) for i in [0, count) on the shared pool, or across all hardware threads
+    template <typename F>
+    void forEachIndividual(int count, F fn) {
+        if (options.pool) {
+            options.pool->parallelFor(count, [&](int idx) { fn(population[idx]); });
+            return;
+        }
         std::atomic<int> individual_idx = 0;
-        std::atomic<int> progress_count = 0;
         unsigned int num_threads = std::thread::hardware_concurrency();
         std::vector<std::thread> threads;
 
         auto worker = [&]() {
             while (true) {
                 int idx = individual_idx.fetch_add(1);
-                if (idx >= populationSize) {
+                if (idx >= count) {
                     break;
                 }
-                evaluateFitnessIndividual(population[idx]);
-                progressBar(progress_count.fetch_add(1) + 1);
+                fn(population[idx]);
             }
         };
 
@@ -109,25 +403,213 @@ private:
         for (auto& thread : threads) {
             thread.join();
         }
+    }
 
-        std::sort(population.begin(), population.end(), [](const Individual& a, const Individual& b) {
-            return a.fitness < b.fitness;
-        });
+    void evaluateFitness() {
+        GA_PROFILE_SCOPE("evaluateFitness");
+        std::atomic<int> progress_count = 0;
+        if (options.fitnessSamples > 0) {
+            refreshFitnessSamples();
+        }
+
+        if (options.remote && options.fitnessSamples == 0 && !options.errorTables) {
+            evaluateFitnessRemote();
+        } else {
+            forEachIndividual(populationSize, [&](Individual& individual) {
+                evaluateFitnessIndividual(individual);
+                progressBar(progress_count.fetch_add(1) + 1);
+            });
+        }
+        for (auto& individual : population) {
+            creditOperators(individual);
+        }
+
+        {
+            GA_PROFILE_SCOPE("sort");
+            std::sort(population.begin(), population.end(), [](const Individual& a, const Individual& b) {
+                return a.fitness < b.fitness;
+            });
+        }
         std::cout << "Best fitness: " << population[0].fitness << std::endl;
     }
     
+    // Ships every renderable individual to the workers; over-budget ones are settled here
+    void evaluateFitnessRemote() {
+        std::vector<Individual*> batch;
+        batch.reserve(population.size());
+        for (auto& individual : population) {
+            if (options.adaptiveOperators && individual.operatorsApplied) individual.operatorCost = scoringWork(individual, true);
+            if (!scoreOverBudget(individual)) batch.push_back(&individual);
+        }
+        options.remote->evaluate(batch, currentLevel);
+        progressBar(populationSize);
+    }
+
+    bool shouldPromote(int generationsAtLevel, int generationsSinceImprovement) const {
+        int perLevel = options.generationsPerLevel;
+        if (perLevel <= 0) {
+            // No explicit schedule: spend at most the first half of the run on the coarse levels.
+            // Elitist runs rarely stall completely, so stagnation alone may never promote.
+            perLevel = std::max(1, generations / (2 * (static_cast<int>(pyramid.size()) - 1)));
+        }
+        if (generationsAtLevel >= perLevel) return true;
+        return options.stagnationGenerations > 0 && generationsSinceImprovement >= options.stagnationGenerations;
+    }
+
+    // Scores an individual over the pixel budget without rendering it; false when within budget
+    bool scoreOverBudget(Individual& individual) {
+        if (pixelBudget == 0) return false;
+        const uint64_t cost = pixelCost(individual);
+        if (cost <= pixelBudget) return false;
+        // Past the largest possible error, so any renderable individual ranks ahead
+        const double worst = 255.0 * 4.0 * imgWidth * imgHeight;
+        individual.fitness = worst * (1.0 + static_cast<double>(cost) / static_cast<double>(pixelBudget));
+        individual.fitnessInterval = 0.0;
+        return true;
+    }
+
+    // Pixels the next evaluation of `individual` renders and compares on the current level, following
+    // the path evaluateFitnessIndividual takes (or a full render when `fullRender`, as remote workers
+    // do). Read before evaluating: the dirty region and cached prefix are reset by it.
+    double scoringWork(const Individual& individual, bool fullRender) const {
+        const PyramidLevel& level = pyramid[currentLevel];
+        if (!fullRender && options.fitnessSamples > 0) {
+            // Every gene is tested against every sample point, then the samples are compared
+            return static_cast<double>(samplePoints.size()) * (individual.dna.size() + 1);
+        }
+        if (!fullRender && options.errorTables) {
+            const ErrorTable* table = individual.errorTable.get();
+            if (table && table->getWidth() == level.width && table->getHeight() == level.height && table->getScale() == level.scale
+                && table->getMode() == blendMode) {
+                const Rect region = scaledRegion(individual.dirty, level.scale, level.width, level.height);
+                return static_cast<double>(individualPixelCost(individual, region, level.scale) + region.area());
+            }
+        }
+        uint64_t pixels = 0;
+        size_t first = 0;
+        if (!fullRender && !options.errorTables && options.checkpointInterval > 0) {
+            const RenderCheckpoints* cache = individual.renderCache.get();
+            const size_t interval = static_cast<size_t>(options.checkpointInterval);
+            if (cache && cache->width == level.width && cache->height == level.height && cache->scale == level.scale && cache->mode == blendMode
+                && cache->interval == interval) {
+                first = std::min(cache->canvases.size(), individual.cachedPrefix / interval) * interval;
+            }
+        }
+        for (auto it = individual.dna.iteratorAt(first); it != individual.dna.end(); ++it) {
+            pixels += genePixelCost(*it, level.width, level.height, level.scale);
+        }
+        return static_cast<double>(pixels + level.size());
+    }
+
     void evaluateFitnessIndividual(Individual& individual) {
-        std::vector<Pixel32> individualPixels = renderIndividualToPixels(imgWidth, imgHeight, individual, blendMode);
-        double fitness = 0.0;
-        for (size_t i = 0; i < originalPixels.size(); ++i) {
-            const Pixel32& originalPixel = originalPixels[i];
-            const Pixel32& individualPixel = individualPixels[i];
-            fitness += std::abs(originalPixel.r - individualPixel.r);
-            fitness += std::abs(originalPixel.g - individualPixel.g);
-            fitness += std::abs(originalPixel.b - individualPixel.b);
-            fitness += std::abs(originalPixel.a - individualPixel.a);
-        }
-        individual.fitness = fitness;
+        if (options.adaptiveOperators && individual.operatorsApplied) individual.operatorCost = scoringWork(individual, false);
+        if (scoreOverBudget(individual)) return;
+        if (options.fitnessSamples > 0) {
+            estimateFitnessIndividual(individual);
+        } else {
+            exactFitnessIndividual(individual);
+        }
+    }
+
+    // Stratified sampling: the level is cut into a grid of cells and every cell gets the same
+    // number of uniformly placed samples. All individuals share the points within a generation.
+    void refreshFitnessSamples() {
+        const PyramidLevel& level = pyramid[currentLevel];
+        int cells = std::max(1, options.fitnessSamples / 4);
+        int gx = std::clamp(static_cast<int>(std::lround(std::sqrt(cells * static_cast<double>(level.width) / level.height))), 1, level.width);
+        int gy = std::clamp(cells / gx, 1, level.height);
+        samplesPerStratum = std::max(2, options.fitnessSamples / (gx * gy));
+
+        samplePoints.clear();
+        stratumArea.clear();
+        for (int cy = 0; cy < gy; ++cy) {
+            int y0 = cy * level.height / gy, y1 = (cy + 1) * level.height / gy - 1;
+            for (int cx = 0; cx < gx; ++cx) {
+                int x0 = cx * level.width / gx, x1 = (cx + 1) * level.width / gx - 1;
+                stratumArea.push_back(static_cast<double>(x1 - x0 + 1) * (y1 - y0 + 1));
+                for (int k = 0; k < samplesPerStratum; ++k) {
+                    samplePoints.push_back(Position{rand.getInt(x0, x1), rand.getInt(y0, y1)});
+                }
+            }
+        }
+    }
+
+    void estimateFitnessIndividual(Individual& individual) {
+        const PyramidLevel& level = pyramid[currentLevel];
+        std::vector<Pixel32> sampled;
+        {
+            GA_PROFILE_SCOPE("render");
+            sampled = renderIndividualAtPoints(individual, blendMode, samplePoints, level.scale);
+        }
+        GA_PROFILE_SCOPE("score");
+
+        double total = 0.0;
+        double variance = 0.0;
+        for (size_t c = 0; c < stratumArea.size(); ++c) {
+            double sum = 0.0, sumSq = 0.0;
+            for (int k = 0; k < samplesPerStratum; ++k) {
+                size_t i = c * samplesPerStratum + k;
+                const Pixel32& o = level.at(samplePoints[i].x, samplePoints[i].y);
+                const Pixel32& p = sampled[i];
+                double err = std::abs(o.r - p.r) + std::abs(o.g - p.g) + std::abs(o.b - p.b) + std::abs(o.a - p.a);
+                sum += err;
+                sumSq += err * err;
+            }
+            double mean = sum / samplesPerStratum;
+            double sampleVar = std::max(0.0, (sumSq - sum * mean) / (samplesPerStratum - 1));
+            total += stratumArea[c] * mean;
+            variance += stratumArea[c] * stratumArea[c] * sampleVar / samplesPerStratum;
+        }
+
+        double toFullResolution = (static_cast<double>(imgWidth) * imgHeight) / level.size();
+        individual.fitness = total * toFullResolution;
+        individual.fitnessInterval = 1.96 * std::sqrt(variance) * toFullResolution;
+    }
+
+    // Ranking came from estimates; settle the top candidates exactly against pyramid[level]. Before
+    // elitism that is the current level, the target the estimates approximate, so elites are picked
+    // by comparable scores; coarse levels are not full resolution. finishRun() settles the returned
+    // best against level 0.
+    void rescoreFinalists(int level) {
+        GA_PROFILE_SCOPE("rescoreFinalists");
+        int finalists = std::min(populationSize, elitismCount + options.exactFinalists);
+        forEachIndividual(finalists, [&](Individual& individual) {
+            if (!scoreOverBudget(individual)) exactFitnessIndividual(individual, level);
+        });
+        std::sort(population.begin(), population.begin() + finalists, [](const Individual& a, const Individual& b) {
+            return a.fitness < b.fitness;
+        });
+    }
+
+    void exactFitnessIndividual(Individual& individual) {
+        exactFitnessIndividual(individual, currentLevel);
+    }
+
+    void exactFitnessIndividual(Individual& individual, int levelIndex) {
+        const PyramidLevel& level = pyramid[levelIndex];
+        const Image& target = level;
+        if (options.errorTables) {
+            GA_PROFILE_SCOPE("render+score incremental");
+            double error = scoreIndividualIncremental(level.width, level.height, level.data(), individual, blendMode, level.scale);
+            individual.fitness = error * (static_cast<double>(imgWidth) * imgHeight) / target.size();
+            individual.fitnessInterval = 0.0;
+            return;
+        }
+        thread_local PixelBuffer individualPixels; // reused by pool threads across evaluations and jobs
+        {
+            GA_PROFILE_SCOPE("render");
+            if (options.checkpointInterval > 0) {
+                individualPixels = renderIndividualCached(level.width, level.height, individual, blendMode, options.checkpointInterval, level.scale);
+            } else {
+                renderIndividualInto(level.width, level.height, individual, blendMode, individualPixels, level.scale);
+            }
+        }
+        GA_PROFILE_SCOPE("score");
+        // Pyramid levels share the canvas layout, so the whole padded buffer is compared in one pass
+        double fitness = static_cast<double>(pixelAbsDiffSum(target.data(), individualPixels.data(), individualPixels.size()));
+        // Scale coarse-level errors up to full-resolution pixel count so values stay comparable
+        individual.fitness = fitness * (static_cast<double>(imgWidth) * imgHeight) / target.size();
+        individual.fitnessInterval = 0.0;
 
         // Penalize if close to maxGeneSize
         double percentil = static_cast<double>(individual.dna.size() - minGeneSize) / static_cast<double>(maxGeneSize - minGeneSize);
@@ -135,6 +617,7 @@ private:
     }
 
     void progressBar(int current) {
+        GA_PROFILE_SCOPE("progressBar");
         std::lock_guard<std::mutex> lock(cout_mutex);
         std::cout << "Evaluating fitness: ";
         const int barWidth = 50;
@@ -153,8 +636,314 @@ private:
         }
     }
 
+    // Waits for the snapshot and checkpoint writers to finish the run's output
+    void finishRun() {
+        if (currentLevel > 0) {
+            // The caller renders and saves the best at full resolution, so rank it there
+            std::cout << "Run ended on pyramid level " << currentLevel << ", re-scoring at full resolution" << std::endl;
+            currentLevel = 0;
+            evaluateFitness();
+        }
+        if (options.fitnessSamples > 0) {
+            // The last generation was ranked by estimates, possibly on a coarse level
+            rescoreFinalists(0);
+            std::cout << "Best fitness (exact, full resolution): " << population[0].fitness << std::endl;
+        }
+        if (snapshotWriter) {
+            snapshotWriter->flush();
+        }
+        if (!checkpointWriter.wait()) {
+            std::cerr << "Failed to write checkpoint " << options.checkpointPath << std::endl;
+        }
+    }
+
+    /**
+     * Steady-state (mu+lambda) evolution with no generation barrier.
+     *
+     * Every thread loops on its own: two tournaments over the live population,
+     * crossover, mutation, exact scoring, then the child replaces the current
+     * worst member if it is better. Parents are read through atomically loaded
+     * shared_ptr snapshots, so breeding and scoring never take a lock. Only the
+     * replacement (a scan of populationSize fitness values) is serialized. A thread
+     * that finishes a slow evaluation just inserts late while the others carry on.
+     *
+     * The evaluation budget matches the generational engine: populationSize -
+     * elitismCount children per "generation". Every such batch of insert attempts
+     * counts as one generation for logging, onGeneration, snapshots and checkpoints.
+     * Those run on whichever thread completes the batch, inside the replacement
+     * lock. Each thread has its own Random, so seeded runs reproduce only
+     * single-threaded.
+     */
+    void runSteadyState(int firstGeneration) {
+        options.fitnessSamples = 0; // estimates on different sample sets are not comparable
+        if (currentLevel != 0) {    // resumed from a generational run on a coarse level
+            currentLevel = 0;
+            evaluateFitness();
+        }
+
+        const int perGeneration = std::max(1, populationSize - elitismCount);
+        const long long budget = static_cast<long long>(generations - firstGeneration) * perGeneration;
+        std::vector<std::shared_ptr<const Individual>> slots;
+        for (auto& individual : population) slots.push_back(std::make_shared<const Individual>(std::move(individual)));
+        std::atomic<long long> started{0};
+        long long completed = 0; // guarded by insertMutex
+        std::mutex insertMutex;
+
+        auto tournament = [&](Random& r) {
+            std::shared_ptr<const Individual> best;
+            for (int i = 0; i < tournamentSize; ++i) {
+                std::shared_ptr<const Individual> contender = std::atomic_load(&slots[r.getInt(0, populationSize - 1)]);
+                if (!best || contender->fitness < best->fitness) best = std::move(contender);
+            }
+            return best;
+        };
+
+        // Under insertMutex: slots are only replaced under the lock, so they can be read directly
+        auto endGeneration = [&](int gen) {
+            GA_PROFILE_SCOPE("generation");
+            population.clear();
+            for (const auto& slot : slots) population.push_back(*slot);
+            std::sort(population.begin(), population.end(), [](const Individual& a, const Individual& b) {
+                return a.fitness < b.fitness;
+            });
+            std::cout << "Generation " << gen + 1 << ". Best fitness: " << population[0].fitness;
+            std::cout << " with " << population[0].dna.size() << " genes covering " << pixelCost(population[0]) << " px." << std::endl;
+            if (migrationDue(gen)) {
+                migrate();
+                for (int i = 0; i < populationSize; ++i) {
+                    std::atomic_store(&slots[i], std::make_shared<const Individual>(population[i]));
+                }
+            }
+            if (options.onGeneration) {
+                options.onGeneration(gen + 1, population[0]);
+            }
+            if (options.snapshotEvery > 0 && gen % options.snapshotEvery == 0) {
+                GA_PROFILE_SCOPE("snapshot");
+                snapshotWriter->submit(population[0], imgWidth, imgHeight, blendMode, options.outputDirectory + "/Generation " + std::to_string(gen + 1) + "." + options.snapshotFormat);
+            }
+            if (!options.checkpointPath.empty() && options.checkpointEvery > 0 && (gen + 1) % options.checkpointEvery == 0) {
+                GA_PROFILE_SCOPE("checkpoint");
+                checkpointWriter.submit(options.checkpointPath, checkpointState(gen + 1));
+            }
+        };
+
+        auto worker = [&](int index) {
+            Random r;
+            if (options.seed != 0) r.seed(options.seed + 7919u * static_cast<unsigned int>(index + 1) + static_cast<unsigned int>(firstGeneration));
+            while (started.fetch_add(1) < budget) {
+                Individual child;
+                {
+                    GA_PROFILE_SCOPE("breed");
+                    child = crossover(*tournament(r), *tournament(r), r);
+                    maybeMutate(child, r);
+                    fitPixelBudget(child);
+                }
+                evaluateFitnessIndividual(child);
+                creditOperators(child);
+
+                GA_PROFILE_SCOPE("insert");
+                std::lock_guard<std::mutex> lock(insertMutex);
+                size_t worst = 0;
+                for (size_t i = 1; i < slots.size(); ++i) {
+                    if (slots[i]->fitness > slots[worst]->fitness) worst = i;
+                }
+                if (child.fitness < slots[worst]->fitness) {
+                    std::atomic_store(&slots[worst], std::shared_ptr<const Individual>(std::make_shared<const Individual>(std::move(child))));
+                }
+                if (++completed % perGeneration == 0) {
+                    endGeneration(firstGeneration + static_cast<int>(completed / perGeneration) - 1);
+                }
+            }
+        };
+
+        if (options.pool) {
+            options.pool->parallelFor(static_cast<int>(options.pool->size()), worker);
+        } else {
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < std::max(1u, std::thread::hardware_concurrency()); ++i) threads.emplace_back(worker, static_cast<int>(i));
+            for (auto& thread : threads) thread.join();
+        }
+
+        population.clear();
+        for (const auto& slot : slots) population.push_back(*slot);
+        std::sort(population.begin(), population.end(), [](const Individual& a, const Individual& b) {
+            return a.fitness < b.fitness;
+        });
+    }
+
+    /**
+     * (1+lambda) hill climbing, or simulated annealing when options.temperature > 0.
+     *
+     * The population is only the starting point: its best member and one ErrorTable (canvas plus
+     * summed-area error) are all that is kept. Every step, lambda copies each get one local
+     * change (mutateOnce) in parallel. Each copy renders only its dirty rectangle into a scratch patch. Its fitness is
+     * the table total with that rectangle's error swapped for the patch's, one O(1) lookup plus
+     * the patch. The best candidate is accepted by the improvement or annealing rule, and its
+     * patch is copied into the canvas. Candidates therefore cost the area of their changes
+     * rather than a full render each. Only the accepted patch updates the table, and that
+     * re-accumulates the integral below and to the right of it (see ErrorTable).
+     *
+     * The evaluation budget matches the generational engine: a generation is as many steps as
+     * it takes to try populationSize - elitismCount candidates. Logging, onGeneration, snapshots
+     * and checkpoints see the best individual so far in population[0]. Migration is not used.
+     * Each candidate slot has its own Random, so seeded runs reproduce with any thread count.
+     */
+    void runHillClimb(int firstGeneration) {
+        options.fitnessSamples = 0;
+        currentLevel = 0;
+        const PyramidLevel& target = pyramid[0];
+        std::unique_ptr<ThreadPool> ownPool;
+        ThreadPool* pool = options.pool;
+        if (!pool) {
+            ownPool = std::make_unique<ThreadPool>();
+            pool = ownPool.get();
+        }
+        const int lambda = options.climbCandidates > 0 ? options.climbCandidates : static_cast<int>(pool->size());
+        const int stepsPerGeneration = (std::max(1, populationSize - elitismCount) + lambda - 1) / lambda;
+        const double totalSteps = static_cast<double>(generations) * stepsPerGeneration;
+
+        // A checkpoint from this climb carries the genome being climbed, the step count and every
+        // slot's RNG, so the resumed run continues exactly. Without one (older checkpoints, another
+        // engine or a different candidate count) the climb restarts from the best so far.
+        const bool restored = static_cast<int>(resumedClimb.slotRngStates.size()) == lambda;
+        Individual current = restored ? resumedClimb.current : population[0];
+        current.errorTable.reset();
+        current.renderCache.reset();
+        current.dirty = Rect::none();
+        ErrorTable table(imgWidth, imgHeight, 1.0, blendMode, target.data(), renderIndividualToPixels(imgWidth, imgHeight, current, blendMode));
+        current.fitness = static_cast<double>(table.totalError());
+        current.fitnessInterval = 0.0;
+        Individual best = current;
+        if (restored) best = population[0];
+
+        struct Candidate {
+            Individual individual;
+            Rect region;        // clipped dirty rectangle
+            PixelBuffer patch;  // its pixels after the mutation
+            double delta = 0.0; // fitness change if accepted
+            double work = 0.0;  // pixels blended and scored to evaluate it
+        };
+        std::vector<Candidate> candidates(lambda);
+        std::vector<std::unique_ptr<Random>> randoms;
+        for (int i = 0; i < lambda; ++i) {
+            randoms.push_back(std::make_unique<Random>());
+            if (restored) {
+                if (!randoms.back()->restoreState(resumedClimb.slotRngStates[i])) throw std::runtime_error("Corrupt hill-climb RNG state in checkpoint");
+            } else if (options.seed != 0) {
+                randoms.back()->seed(options.seed + 7919u * static_cast<unsigned int>(i + 1) + static_cast<unsigned int>(firstGeneration));
+            }
+        }
+
+        long long step = restored ? resumedClimb.step : static_cast<long long>(firstGeneration) * stepsPerGeneration;
+        resumedClimb = ClimbState();
+        for (int gen = firstGeneration; gen < generations; ++gen) {
+            GA_PROFILE_SCOPE("generation");
+            int accepted = 0;
+            for (int s = 0; s < stepsPerGeneration; ++s, ++step) {
+                pool->parallelFor(lambda, [&](int i) {
+                    GA_PROFILE_SCOPE("candidate");
+                    Candidate& c = candidates[i];
+                    c.individual = current;
+                    mutateOnce(c.individual, *randoms[i]);
+                    fitPixelBudget(c.individual);
+                    c.region = c.individual.dirty.clipped(imgWidth, imgHeight);
+                    c.delta = 0.0;
+                    c.work = 0.0;
+                    if (!c.region.empty()) {
+                        c.work = static_cast<double>(renderIndividualPatch(c.individual, blendMode, c.region, c.patch) + c.region.area());
+                        c.delta = static_cast<double>(table.regionErrorWith(target.data(), c.region, c.patch.data()))
+                                  - static_cast<double>(table.regionError(c.region));
+                    }
+                });
+
+                if (options.adaptiveOperators) {
+                    // One operator per candidate, and its patch is exactly the work it caused.
+                    // Recorded in slot order, so the schedule does not depend on thread timing.
+                    for (auto& c : candidates) {
+                        for (int k = 0; k < MUTATION_OPERATORS; ++k) {
+                            if ((c.individual.operatorsApplied >> k) & 1) {
+                                operators.record(static_cast<MutationOperator>(k), -c.delta, c.work);
+                            }
+                        }
+                        c.individual.operatorsApplied = 0;
+                    }
+                }
+
+                size_t pick = 0;
+                for (size_t i = 1; i < candidates.size(); ++i) {
+                    if (candidates[i].delta < candidates[pick].delta) pick = i;
+                }
+                Candidate& c = candidates[pick];
+                const double temperature = options.temperature * (1.0 - step / totalSteps);
+                if (c.delta <= 0.0 || (temperature > 0.0 && rand.getDouble() < std::exp(-c.delta / temperature))) {
+                    GA_PROFILE_SCOPE("accept");
+                    if (!c.region.empty()) table.replaceRegion(target.data(), c.region, c.patch.data());
+                    current = std::move(c.individual);
+                    current.dirty = Rect::none();
+                    current.fitness = static_cast<double>(table.totalError());
+                    if (current.fitness <= best.fitness) best = current;
+                    ++accepted;
+                }
+            }
+
+            population[0] = best;
+            std::cout << "Generation " << gen + 1 << ". Best fitness: " << best.fitness << " with " << best.dna.size() << " genes covering "
+                      << pixelCost(best) << " px. Accepted " << accepted << "/" << stepsPerGeneration << " steps of " << lambda << " candidates.";
+            if (options.adaptiveOperators) std::cout << " Operators: " << operators.summary();
+            std::cout << std::endl;
+            if (options.onGeneration) {
+                options.onGeneration(gen + 1, best);
+            }
+            if (options.snapshotEvery > 0 && gen % options.snapshotEvery == 0) {
+                GA_PROFILE_SCOPE("snapshot");
+                snapshotWriter->submit(best, imgWidth, imgHeight, blendMode, options.outputDirectory + "/Generation " + std::to_string(gen + 1) + "." + options.snapshotFormat);
+            }
+            if (!options.checkpointPath.empty() && options.checkpointEvery > 0 && (gen + 1) % options.checkpointEvery == 0) {
+                GA_PROFILE_SCOPE("checkpoint");
+                CheckpointState state = checkpointState(gen + 1);
+                for (const auto& r : randoms) state.climb.slotRngStates.push_back(r->saveState());
+                state.climb.step = step;
+                state.climb.current = current;
+                checkpointWriter.submit(options.checkpointPath, std::move(state));
+            }
+        }
+        population[0] = best;
+    }
+
+    bool migrationDue(int gen) const {
+        return options.migration && options.migrationInterval > 0 && (gen + 1) % options.migrationInterval == 0;
+    }
+
+    // Sends copies of the best individuals to the neighbouring islands and puts whatever has
+    // arrived in place of the worst (never the elites). Expects and leaves population sorted.
+    void migrate() {
+        GA_PROFILE_SCOPE("migrate");
+        const int emigrants = std::min(options.migrants, populationSize);
+        for (int target : migrationTargets(options.topology, options.island, options.migration->islands(), rand)) {
+            for (int i = 0; i < emigrants; ++i) options.migration->send(target, population[i]);
+        }
+
+        std::vector<Individual> arrivals = options.migration->receive(options.island);
+        const size_t room = static_cast<size_t>(populationSize - std::max(1, elitismCount));
+        if (arrivals.size() > room) arrivals.erase(arrivals.begin(), arrivals.end() - room); // keep the newest
+        for (size_t i = 0; i < arrivals.size(); ++i) {
+            // Re-scored here: the sender may be on another pyramid level or sample set
+            evaluateFitnessIndividual(arrivals[i]);
+            population[populationSize - 1 - i] = std::move(arrivals[i]);
+        }
+        if (!arrivals.empty()) {
+            std::sort(population.begin(), population.end(), [](const Individual& a, const Individual& b) {
+                return a.fitness < b.fitness;
+            });
+        }
+    }
+
     void selection() {
+        GA_PROFILE_SCOPE("selection");
         // Elitism
+        if (options.fitnessSamples > 0) {
+            rescoreFinalists(currentLevel);
+        }
         std::vector<Individual> newPopulation;
         for (int i = 0; i < elitismCount; ++i) {
             elite.push_back(population[i]);
@@ -163,7 +952,7 @@ private:
 
         // Tournament selection
         while (newPopulation.size() < populationSize - elitismCount) {
-            Individual child = crossover(tournamentSelection(tournamentSize), tournamentSelection(tournamentSize));
+            Individual child = crossover(tournamentSelection(tournamentSize), tournamentSelection(tournamentSize), rand);
             newPopulation.push_back(child);
         }
         population = newPopulation;
@@ -185,47 +974,74 @@ private:
 
 
 
-    Individual crossover(const Individual& parent1, const Individual& parent2) {
+    // Thread-safe given a Random per thread: reads only the parents and immutable settings
+    Individual crossover(const Individual& parent1, const Individual& parent2, Random& rand) {
+        GA_PROFILE_SCOPE("crossover");
         Individual child;
+        child.parentFitness = std::min(parent1.fitness, parent2.fitness);
         size_t size1 = parent1.dna.size();
         size_t size2 = parent2.dna.size();
         size_t minSize = std::min(size1, size2);
         size_t crossoverPoint = rand.getInt(0, static_cast<int>(minSize));
 
-        for (size_t i = 0; i < crossoverPoint; ++i) {
-            child.dna.push_back(parent1.dna[i].clone());
-        }
-        for (size_t i = crossoverPoint; i < size2; ++i) {
-            child.dna.push_back(parent2.dna[i].clone());
+        // Whole chunks are shared with the parents; only the chunks cut by the crossover point are copied
+        child.dna = parent1.dna.slice(0, crossoverPoint);
+        child.dna.append(parent2.dna.slice(crossoverPoint, size2));
+
+        // The prefix came from parent1 unchanged, so its render checkpoints still apply
+        child.renderCache = parent1.renderCache;
+        child.cachedPrefix = std::min(parent1.cachedPrefix, crossoverPoint);
+
+        // Likewise the error table: only the area under the swapped-out and swapped-in suffixes changes
+        if (options.errorTables) {
+            child.errorTable = parent1.errorTable;
+            child.dirty = parent1.dirty;
+            for (auto it = parent1.dna.iteratorAt(crossoverPoint); it != parent1.dna.end(); ++it) child.dirty = child.dirty.united(it->bounds());
+            for (auto it = parent2.dna.iteratorAt(crossoverPoint); it != parent2.dna.end(); ++it) child.dirty = child.dirty.united(it->bounds());
         }
 
         return child;
     }
 
     void mutation() {
+        GA_PROFILE_SCOPE("mutation");
         int count = 0;
         for (auto& individual : population) {
-            if (maybeMutate(individual)) {
+            if (maybeMutate(individual, rand)) {
                 ++count;
             }
+            fitPixelBudget(individual);
         }
-        std::cout << "Mutations applied: " << count << "/" << populationSize << std::endl;
+        std::cout << "Mutations applied: " << count << "/" << populationSize;
+        if (options.adaptiveOperators) std::cout << " (" << operators.summary() << ")";
+        std::cout << std::endl;
     }
 
     void applyElitism() {
+        GA_PROFILE_SCOPE("elitism");
         population.insert(population.end(), elite.begin(), elite.end());
         elite.clear();
     }
 
 
-    bool maybeMutate(Individual& individual) {
+    bool maybeMutate(Individual& individual, Random& rand) {
         bool mutated = false;
+        if (options.adaptiveOperators) {
+            // As many changes as the fixed odds below give (three 50% draws); the scheduler picks which
+            for (int i = 0; i < 3; ++i) {
+                if (rand.getDouble(0.0, 1.0) < 0.5) {
+                    applyOperator(individual, operators.select(rand), rand);
+                    mutated = true;
+                }
+            }
+            return mutated;
+        }
         if (rand.getDouble(0.0, 1.0) < 0.5) { // 10% mutation rate
-            individual.mutate_random_gene(rand, imgWidth, imgHeight);
+            individual.mutate_random_gene(rand, imgWidth, imgHeight, maxGeneLength);
             mutated = true;
         }
         if (rand.getDouble(0.0, 1.0) < 0.5) { // 10% mutation rate
-            individual.add_random_gene(rand, imgWidth, imgHeight, maxGeneSize, shapeType);
+            individual.add_random_gene(rand, imgWidth, imgHeight, minGeneLength, maxGeneLength, shapeType);
             mutated = true;
         }
         if (rand.getDouble(0.0, 1.0) < 0.5) { // 50% mutation rate
@@ -234,4 +1050,59 @@ private:
         }
         return mutated;}
 
+    // A single gene mutation, insertion or deletion: the small, local change hill climbing relies on
+    void mutateOnce(Individual& individual, Random& rand) {
+        if (options.adaptiveOperators) {
+            applyOperator(individual, operators.select(rand), rand);
+            return;
+        }
+        switch (individual.dna.empty() ? 1 : rand.getInt(0, 2)) {
+            case 0:
+                individual.mutate_random_gene(rand, imgWidth, imgHeight, maxGeneLength);
+                break;
+            case 1:
+                individual.add_random_gene(rand, imgWidth, imgHeight, minGeneLength, maxGeneLength, shapeType);
+                break;
+            case 2:
+                individual.delete_random_gene(rand);
+                break;
+        }
+    }
+
+    void applyOperator(Individual& individual, MutationOperator op, Random& rand) {
+        switch (op) {
+            case MutationOperator::Position:
+                individual.mutate_random_gene(rand, imgWidth, imgHeight, maxGeneLength, GeneMutation::Position);
+                break;
+            case MutationOperator::Color:
+                individual.mutate_random_gene(rand, imgWidth, imgHeight, maxGeneLength, GeneMutation::Color);
+                break;
+            case MutationOperator::Length:
+                individual.mutate_random_gene(rand, imgWidth, imgHeight, maxGeneLength, GeneMutation::Length);
+                break;
+            case MutationOperator::Add:
+                individual.add_random_gene(rand, imgWidth, imgHeight, minGeneLength, maxGeneLength, shapeType);
+                break;
+            case MutationOperator::Delete:
+                individual.delete_random_gene(rand);
+                break;
+        }
+        individual.operatorsApplied |= 1u << static_cast<int>(op);
+    }
+
+    // Splits a scored child's gain over its better parent, and the pixels its evaluation rendered and
+    // compared (operatorCost, see scoringWork), among the operators that made it. Cheap changes, such
+    // as a small dirty region or a short re-rendered suffix, count for less than costly ones. The hill
+    // climber records the pixels each candidate's patch took itself.
+    void creditOperators(Individual& child) {
+        if (!options.adaptiveOperators || child.operatorsApplied == 0) return;
+        int applied = 0;
+        for (int i = 0; i < MUTATION_OPERATORS; ++i) applied += (child.operatorsApplied >> i) & 1;
+        const double gain = std::max(0.0, child.parentFitness - child.fitness) / applied;
+        for (int i = 0; i < MUTATION_OPERATORS; ++i) {
+            if ((child.operatorsApplied >> i) & 1) operators.record(static_cast<MutationOperator>(i), gain, child.operatorCost / applied);
+        }
+        child.operatorsApplied = 0;
+    }
+
 };
\ No newline at end of file
@@ -0,0 +1,184 @@
+// Persisting evolved genomes: SVG export and a compact binary DNA format
+#pragma once
+#include "Individual.h"
+#include "Render.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <istream>
+
+/*
+ * Binary genome format (little-endian, version 1). A file is any number of
+ * records back to back, so genomes can be appended to one stream and read
+ * back one at a time. Every field has a fixed width and offset, so a mapped
+ * file can be indexed in place.
+ *
+ *   offset  size  field
+ *   0       4     magic "GADN"
+ *   4       4     version (1)
+ *   8       4     width of the target the genome was evolved for
+ *   12      4     height
+ *   16      4     gene count
+ *   20      4     blend mode
+ *   24      8     fitness (IEEE double)
+ *   32      16*n  genes: int32 x, int32 y, uint32 length (low 24 bits) | shape << 24, uint8 r, g, b, a
+ */
+static const char GENOME_MAGIC[4] = {'G', 'A', 'D', 'N'};
+static const uint32_t GENOME_VERSION = 1;
+static const size_t GENOME_HEADER_SIZE = 32;
+static const size_t GENOME_GENE_SIZE = 16;
+
+struct Genome {
+    int width = 0;
+    int height = 0;
+    BlendMode mode = BlendMode::AlphaOver;
+    double fitness = 0.0;
+    Individual individual;
+};
+
+static inline void genome_put32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+static inline uint32_t genome_get32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline std::vector<uint8_t> encodeGenome(const Individual& individual, int width, int height, BlendMode mode) {
+    std::vector<uint8_t> out(GENOME_HEADER_SIZE + GENOME_GENE_SIZE * individual.dna.size());
+    uint8_t* p = out.data();
+    std::memcpy(p, GENOME_MAGIC, 4);
+    genome_put32(p + 4, GENOME_VERSION);
+    genome_put32(p + 8, static_cast<uint32_t>(width));
+    genome_put32(p + 12, static_cast<uint32_t>(height));
+    genome_put32(p + 16, static_cast<uint32_t>(individual.dna.size()));
+    genome_put32(p + 20, static_cast<uint32_t>(mode));
+    uint64_t bits;
+    std::memcpy(&bits, &individual.fitness, sizeof(bits));
+    genome_put32(p + 24, static_cast<uint32_t>(bits));
+    genome_put32(p + 28, static_cast<uint32_t>(bits >> 32));
+
+    p += GENOME_HEADER_SIZE;
+    for (const auto& g : individual.dna) {
+        const Position pos = g.getPosition();
+        const Color c = g.getColor();
+        genome_put32(p, static_cast<uint32_t>(pos.x));
+        genome_put32(p + 4, static_cast<uint32_t>(pos.y));
+        genome_put32(p + 8, (static_cast<uint32_t>(g.getLength()) & 0xFFFFFFu) | (static_cast<uint32_t>(g.getType()) << 24));
+        p[12] = c.r;
+        p[13] = c.g;
+        p[14] = c.b;
+        p[15] = c.a;
+        p += GENOME_GENE_SIZE;
+    }
+    return out;
+}
+
+// Parses one record from a buffer (e.g. a mapped file). Returns the bytes consumed, 0 if malformed or truncated.
+inline size_t decodeGenome(const uint8_t* data, size_t size, Genome& out) {
+    if (size < GENOME_HEADER_SIZE || std::memcmp(data, GENOME_MAGIC, 4) != 0 || genome_get32(data + 4) != GENOME_VERSION) return 0;
+    const uint32_t count = genome_get32(data + 16);
+    const uint32_t mode = genome_get32(data + 20);
+    if (mode > static_cast<uint32_t>(BlendMode::Overwrite)) return 0;
+    const size_t total = GENOME_HEADER_SIZE + GENOME_GENE_SIZE * static_cast<size_t>(count);
+    if (size < total) return 0;
+
+    out.width = static_cast<int>(genome_get32(data + 8));
+    out.height = static_cast<int>(genome_get32(data + 12));
+    out.mode = static_cast<BlendMode>(mode);
+    uint64_t bits = genome_get32(data + 24) | (static_cast<uint64_t>(genome_get32(data + 28)) << 32);
+    std::memcpy(&out.fitness, &bits, sizeof(bits));
+    out.individual = Individual();
+    out.individual.fitness = out.fitness;
+
+    const uint8_t* p = data + GENOME_HEADER_SIZE;
+    for (uint32_t i = 0; i < count; ++i, p += GENOME_GENE_SIZE) {
+        uint32_t lengthAndShape = genome_get32(p + 8);
+        uint32_t shape = lengthAndShape >> 24;
+        if (shape > static_cast<uint32_t>(ShapeType::Square)) return 0;
+        Color c{p[12], p[13], p[14], p[15]};
+        out.individual.dna.push_back(Gene(static_cast<int32_t>(genome_get32(p)), static_cast<int32_t>(genome_get32(p + 4)), c,
+                                          static_cast<ShapeType>(shape), static_cast<int>(lengthAndShape & 0xFFFFFFu)));
+    }
+    return total;
+}
+
+inline bool writeGenome(std::ostream& out, const Individual& individual, int width, int height, BlendMode mode) {
+    std::vector<uint8_t> bytes = encodeGenome(individual, width, height, mode);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+// Reads the next record of a stream; false at end of stream or on a malformed record.
+// The gene count comes from the stream, so it is checked against what a seekable stream has
+// left and the genes are read in bounded chunks: a corrupt count fails at end of stream instead
+// of allocating for it up front.
+inline bool readGenome(std::istream& in, Genome& out) {
+    std::vector<uint8_t> bytes(GENOME_HEADER_SIZE);
+    if (!in.read(reinterpret_cast<char*>(bytes.data()), GENOME_HEADER_SIZE)) return false;
+    if (std::memcmp(bytes.data(), GENOME_MAGIC, 4) != 0 || genome_get32(bytes.data() + 4) != GENOME_VERSION) return false;
+    const size_t genes = genome_get32(bytes.data() + 16);
+    const size_t body = GENOME_GENE_SIZE * genes;
+
+    const std::streampos here = in.tellg();
+    if (here != std::streampos(-1) && in.seekg(0, std::ios::end)) {
+        const std::streamoff left = in.tellg() - here;
+        in.seekg(here);
+        if (left < static_cast<std::streamoff>(body)) return false;
+    }
+    in.clear();
+
+    const size_t chunk = GENOME_GENE_SIZE * 65536;
+    for (size_t done = 0; done < body;) {
+        const size_t n = std::min(chunk, body - done);
+        bytes.resize(GENOME_HEADER_SIZE + done + n);
+        if (!in.read(reinterpret_cast<char*>(bytes.data() + GENOME_HEADER_SIZE + done), static_cast<std::streamsize>(n))) return false;
+        done += n;
+    }
+    return decodeGenome(bytes.data(), bytes.size(), out) != 0;
+}
+
+inline bool saveGenome(const std::string& path, const Individual& individual, int width, int height, BlendMode mode) {
+    std::ofstream out(path, std::ios::binary);
+    return out && writeGenome(out, individual, width, height, mode);
+}
+
+inline std::vector<Genome> loadGenomes(const std::string& path) {
+    std::vector<Genome> genomes;
+    std::ifstream in(path, std::ios::binary);
+    Genome genome;
+    while (readGenome(in, genome)) genomes.push_back(genome);
+    return genomes;
+}
+
+// Circles and squares in DNA order with RGBA fills; SVG's default source-over matches AlphaOver.
+// Additive genes use mix-blend-mode plus-lighter; Overwrite has no SVG equivalent and is drawn as AlphaOver.
+inline bool saveIndividualSVG(const std::string& path, const Individual& individual, int width, int height, BlendMode mode = BlendMode::AlphaOver) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+        << "\" viewBox=\"0 0 " << width << " " << height << "\">\n";
+    const char* blend = (mode == BlendMode::Additive) ? " style=\"mix-blend-mode:plus-lighter\"" : "";
+    for (const auto& g : individual.dna) {
+        const Position pos = g.getPosition();
+        const Color c = g.getColor();
+        const int len = g.getLength();
+        // Pixel (x, y) is the unit square whose centre is (x + 0.5, y + 0.5)
+        if (g.getType() == ShapeType::Circle) {
+            out << "<circle cx=\"" << pos.x + 0.5 << "\" cy=\"" << pos.y + 0.5 << "\" r=\"" << len << "\"";
+        } else {
+            int half = len / 2;
+            out << "<rect x=\"" << pos.x - half << "\" y=\"" << pos.y - half << "\" width=\"" << 2 * half + 1 << "\" height=\"" << 2 * half + 1 << "\"";
+        }
+        out << " fill=\"rgb(" << int(c.r) << "," << int(c.g) << "," << int(c.b) << ")\" fill-opacity=\"" << c.a / 255.0 << "\"" << blend << "/>\n";
+    }
+    out << "</svg>\n";
+    return static_cast<bool>(out);
+}
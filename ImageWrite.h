@@ -0,0 +1,305 @@
+// Bulk image encoders for Pixel32 buffers: TGA, PPM, PAM and store-only PNG.
+// Buffers are rows of `stride` pixels (width for decoded images, canvasStride(width) for canvases).
+#pragma once
+#include "Render.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+// RGBA -> BGRA, four pixels per SSE2 step (swap bytes 0 and 2 of every 32-bit lane)
+inline void swizzleRGBAToBGRA(const Pixel32* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+#ifdef GENETICART_SSE2
+    const __m128i keep = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m128i low = _mm_set1_epi32(0x000000FF);
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i r = _mm_and_si128(v, low);
+        __m128i b = _mm_and_si128(_mm_srli_epi32(v, 16), low);
+        __m128i out = _mm_or_si128(_mm_and_si128(v, keep), _mm_or_si128(_mm_slli_epi32(r, 16), b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), out);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[4 * i + 0] = src[i].b;
+        dst[4 * i + 1] = src[i].g;
+        dst[4 * i + 2] = src[i].r;
+        dst[4 * i + 3] = src[i].a;
+    }
+}
+
+inline void packRGB(const Pixel32* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[3 * i + 0] = src[i].r;
+        dst[3 * i + 1] = src[i].g;
+        dst[3 * i + 2] = src[i].b;
+    }
+}
+
+// Writes header then body with one gathered write where the platform has writev
+inline bool writeFileBulk(const std::string& path, const void* header, size_t headerSize, const void* body, size_t bodySize) {
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    struct iovec iov[2] = {{const_cast<void*>(header), headerSize}, {const_cast<void*>(body), bodySize}};
+    int first = 0;
+    bool ok = true;
+    while (first < 2) {
+        ssize_t written = ::writev(fd, iov + first, 2 - first);
+        if (written < 0) { ok = false; break; }
+        // Partial write: advance past what the kernel accepted
+        size_t left = static_cast<size_t>(written);
+        while (first < 2 && left >= iov[first].iov_len) { left -= iov[first].iov_len; ++first; }
+        if (first < 2) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+            iov[first].iov_len -= left;
+        }
+    }
+    return ::close(fd) == 0 && ok;
+#else
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out.write(static_cast<const char*>(header), static_cast<std::streamsize>(headerSize));
+    out.write(static_cast<const char*>(body), static_cast<std::streamsize>(bodySize));
+    return static_cast<bool>(out);
+#endif
+}
+
+// TGA stores width and height in 16-bit header fields
+static const int TGA_MAX_DIMENSION = 65535;
+
+inline bool savePixelsTGA(const std::string& path, int width, int height, const Pixel32* buffer, int stride) {
+    if (width > TGA_MAX_DIMENSION || height > TGA_MAX_DIMENSION) return false;
+    uint8_t header[18] = {};
+    header[2] = 2;
+    header[12] = static_cast<uint8_t>(width & 0xFF);
+    header[13] = static_cast<uint8_t>((width >> 8) & 0xFF);
+    header[14] = static_cast<uint8_t>(height & 0xFF);
+    header[15] = static_cast<uint8_t>((height >> 8) & 0xFF);
+    header[16] = 32;
+    header[17] = 0x20;
+    std::vector<uint8_t> bgra(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        swizzleRGBAToBGRA(buffer + static_cast<size_t>(y) * stride, bgra.data() + static_cast<size_t>(y) * width * 4, width);
+    }
+    return writeFileBulk(path, header, sizeof(header), bgra.data(), bgra.size());
+}
+
+// Binary PPM (P6); alpha is dropped
+inline bool savePixelsPPM(const std::string& path, int width, int height, const Pixel32* buffer, int stride) {
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; ++y) {
+        packRGB(buffer + static_cast<size_t>(y) * stride, rgb.data() + static_cast<size_t>(y) * width * 3, width);
+    }
+    return writeFileBulk(path, header.data(), header.size(), rgb.data(), rgb.size());
+}
+
+// PAM (P7) RGB_ALPHA stores Pixel32 memory as-is, so unpadded buffers (e.g. a loaded Image) are
+// written without any copy; padded rows are packed first
+inline bool savePixelsPAM(const std::string& path, int width, int height, const Pixel32* buffer, int stride) {
+    const std::string header = "P7\nWIDTH " + std::to_string(width) + "\nHEIGHT " + std::to_string(height)
+                             + "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    if (stride == width) return writeFileBulk(path, header.data(), header.size(), buffer, bytes);
+    std::vector<Pixel32> packed(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        std::copy(buffer + static_cast<size_t>(y) * stride, buffer + static_cast<size_t>(y) * stride + width, packed.begin() + static_cast<size_t>(y) * width);
+    }
+    return writeFileBulk(path, header.data(), header.size(), packed.data(), bytes);
+}
+
+static inline uint32_t imagewrite_crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static inline void imagewrite_put_be32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static inline void imagewrite_png_chunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size) {
+    imagewrite_put_be32(out, static_cast<uint32_t>(size));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    imagewrite_put_be32(out, imagewrite_crc32(out.data() + start, size + 4));
+}
+
+// RGBA PNG with filter 0 rows inside stored (uncompressed) deflate blocks: no compression cost,
+// files are about the size of the raw pixels, and any PNG reader opens them.
+inline bool savePixelsPNG(const std::string& path, int width, int height, const Pixel32* buffer, int stride) {
+    const size_t rowBytes = static_cast<size_t>(width) * 4 + 1;
+    const size_t rawSize = rowBytes * height;
+    const size_t maxBlock = 65535;
+    const size_t blocks = std::max<size_t>(1, (rawSize + maxBlock - 1) / maxBlock);
+
+    std::vector<uint8_t> zlib;
+    zlib.reserve(2 + rawSize + blocks * 5 + 4);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+
+    uint32_t s1 = 1, s2 = 0; // Adler-32 of the raw scanlines
+    size_t blockLeft = 0;
+    size_t remaining = rawSize;
+    auto emit = [&](const uint8_t* data, size_t size) {
+        while (size > 0) {
+            if (blockLeft == 0) {
+                blockLeft = std::min(maxBlock, remaining);
+                remaining -= blockLeft;
+                zlib.push_back(remaining == 0 ? 1 : 0);
+                zlib.push_back(static_cast<uint8_t>(blockLeft & 0xFF));
+                zlib.push_back(static_cast<uint8_t>(blockLeft >> 8));
+                zlib.push_back(static_cast<uint8_t>(~blockLeft & 0xFF));
+                zlib.push_back(static_cast<uint8_t>((~blockLeft >> 8) & 0xFF));
+            }
+            size_t n = std::min(size, blockLeft);
+            zlib.insert(zlib.end(), data, data + n);
+            for (size_t i = 0; i < n; i += 5552) { // largest run before the sums can overflow
+                size_t end = std::min(n, i + 5552);
+                for (size_t j = i; j < end; ++j) { s1 += data[j]; s2 += s1; }
+                s1 %= 65521;
+                s2 %= 65521;
+            }
+            data += n;
+            size -= n;
+            blockLeft -= n;
+        }
+    };
+    const uint8_t filterNone = 0;
+    for (int y = 0; y < height; ++y) {
+        emit(&filterNone, 1);
+        emit(reinterpret_cast<const uint8_t*>(buffer + static_cast<size_t>(y) * stride), static_cast<size_t>(width) * 4);
+    }
+    if (rawSize == 0) {
+        zlib.insert(zlib.end(), {1, 0, 0, 0xFF, 0xFF});
+    }
+    imagewrite_put_be32(zlib, (s2 << 16) | s1);
+
+    std::vector<uint8_t> file = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> ihdr;
+    imagewrite_put_be32(ihdr, static_cast<uint32_t>(width));
+    imagewrite_put_be32(ihdr, static_cast<uint32_t>(height));
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0}); // 8-bit RGBA, deflate, adaptive filtering, no interlace
+    imagewrite_png_chunk(file, "IHDR", ihdr.data(), ihdr.size());
+    size_t headerSize = file.size();
+    // IDAT length + type go in the header; data + CRC are appended to the zlib buffer
+    imagewrite_put_be32(file, static_cast<uint32_t>(zlib.size()));
+    file.insert(file.end(), {'I', 'D', 'A', 'T'});
+    uint32_t crc = imagewrite_crc32(file.data() + headerSize + 4, 4);
+    crc = imagewrite_crc32(zlib.data(), zlib.size(), crc);
+    imagewrite_put_be32(zlib, crc);
+    imagewrite_png_chunk(zlib, "IEND", nullptr, 0);
+    return writeFileBulk(path, file.data(), file.size(), zlib.data(), zlib.size());
+}
+
+// Picks the encoder from the file extension (.tga, .ppm, .pam, .png); unknown extensions get TGA
+inline bool savePixels(const std::string& path, int width, int height, const Pixel32* buffer, int stride) {
+    auto endsWith = [&](const char* ext) {
+        size_t n = std::strlen(ext);
+        return path.size() >= n && path.compare(path.size() - n, n, ext) == 0;
+    };
+    if (endsWith(".png")) return savePixelsPNG(path, width, height, buffer, stride);
+    if (endsWith(".ppm")) return savePixelsPPM(path, width, height, buffer, stride);
+    if (endsWith(".pam")) return savePixelsPAM(path, width, height, buffer, stride);
+    return savePixelsTGA(path, width, height, buffer, stride);
+}
+
+inline bool savePixels(const std::string& path, int width, int height, const PixelBuffer& canvas) {
+    return savePixels(path, width, height, canvas.data(), canvasStride(width));
+}
+
+inline bool savePixels(const std::string& path, const Image& image) {
+    return savePixels(path, image.width, image.height, image.data(), image.stride);
+}
+
+/**
+ * @brief Writes an image one band of rows at a time, top to bottom.
+ *
+ * For outputs too large to hold as one buffer (tiled runs). The format comes from
+ * the extension like savePixels; TGA, PPM and PAM stream, PNG is not supported here.
+ * open() fails for TGA beyond TGA_MAX_DIMENSION; PPM and PAM have no such limit.
+ */
+class PixelStreamWriter {
+public:
+    bool open(const std::string& path, int width, int height) {
+        auto endsWith = [&](const char* ext) {
+            size_t n = std::strlen(ext);
+            return path.size() >= n && path.compare(path.size() - n, n, ext) == 0;
+        };
+        if (endsWith(".png")) return false;
+        const bool tga = !endsWith(".ppm") && !endsWith(".pam");
+        if (tga && (width > TGA_MAX_DIMENSION || height > TGA_MAX_DIMENSION)) return false;
+        this->width = width;
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        if (endsWith(".ppm")) {
+            format = Format::PPM;
+            out << "P6\n" << width << " " << height << "\n255\n";
+        } else if (endsWith(".pam")) {
+            format = Format::PAM;
+            out << "P7\nWIDTH " << width << "\nHEIGHT " << height << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+        } else {
+            format = Format::TGA;
+            uint8_t header[18] = {};
+            header[2] = 2;
+            header[12] = static_cast<uint8_t>(width & 0xFF);
+            header[13] = static_cast<uint8_t>((width >> 8) & 0xFF);
+            header[14] = static_cast<uint8_t>(height & 0xFF);
+            header[15] = static_cast<uint8_t>((height >> 8) & 0xFF);
+            header[16] = 32;
+            header[17] = 0x20;
+            out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool writeRows(const Pixel32* rows, int count, int stride) {
+        const size_t bytesPerPixel = format == Format::PPM ? 3 : 4;
+        scratch.resize(static_cast<size_t>(width) * bytesPerPixel);
+        for (int y = 0; y < count; ++y) {
+            const Pixel32* row = rows + static_cast<size_t>(y) * stride;
+            if (format == Format::PAM) {
+                out.write(reinterpret_cast<const char*>(row), static_cast<std::streamsize>(width) * 4);
+                continue;
+            }
+            if (format == Format::PPM) packRGB(row, scratch.data(), width);
+            else swizzleRGBAToBGRA(row, scratch.data(), width);
+            out.write(reinterpret_cast<const char*>(scratch.data()), static_cast<std::streamsize>(scratch.size()));
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool close() {
+        out.close();
+        return !out.fail();
+    }
+
+private:
+    enum class Format { TGA, PPM, PAM };
+    std::ofstream out;
+    Format format = Format::TGA;
+    int width = 0;
+    std::vector<uint8_t> scratch;
+};
@@ -1,44 +1,83 @@
 #pragma once
 #include "Gene.h"
+#include "GeneRope.h"
 #include "RandomHelper.h"
 #include <memory>
 #include <vector>
 #include <random>
 #include <algorithm>
 
+struct RenderCheckpoints; // see Draw.h
+class ErrorTable;         // see ErrorTable.h
+
+// What mutate_random_gene changes about the gene it picks
+enum class GeneMutation {
+    Position,
+    Color,
+    Length
+};
+
 class Individual {
 public:
-    std::vector<Gene> dna;
+    GeneRope dna; // copies share unchanged gene chunks
     double fitness;
+    double fitnessInterval; // half-width of the 95% confidence interval when fitness is an estimate, 0 when exact
+
+    // Composited prefix canvases from the last cached render, shared read-only with copies
+    std::shared_ptr<const RenderCheckpoints> renderCache;
+    size_t cachedPrefix; // leading genes unchanged since renderCache was built
 
-    Individual() : fitness(0.0) {}
+    // Canvas plus summed-area error table from the last incremental score, and the
+    // full-resolution region changed since then
+    std::shared_ptr<ErrorTable> errorTable;
+    Rect dirty;
+
+    // Adaptive operator scheduling: bit i set when MutationOperator i was applied since the last
+    // evaluation, the better parent's fitness the result is credited against, and the pixels
+    // that evaluation rendered and compared
+    unsigned int operatorsApplied;
+    double parentFitness;
+    double operatorCost;
+
+    Individual() : fitness(0.0), fitnessInterval(0.0), cachedPrefix(0), dirty(Rect::none()), operatorsApplied(0), parentFitness(0.0), operatorCost(0.0) {}
     ~Individual() = default;
 
     Individual(const Individual& other) {
         this->fitness = other.fitness;
-        // Reserve space for efficiency
-        this->dna.reserve(other.dna.size());
-
-        for (const auto& gene : other.dna) {
-            this->dna.push_back(gene.clone());
-        }
+        this->fitnessInterval = other.fitnessInterval;
+        this->renderCache = other.renderCache;
+        this->cachedPrefix = other.cachedPrefix;
+        this->errorTable = other.errorTable;
+        this->dirty = other.dirty;
+        this->operatorsApplied = other.operatorsApplied;
+        this->parentFitness = other.parentFitness;
+        this->operatorCost = other.operatorCost;
+        this->dna = other.dna;
     }
 
     Individual& operator=(const Individual& other) {
         if (this == &other) {
             return *this;
         }
-        this->dna.clear();
         this->fitness = other.fitness;
-        this->dna.reserve(other.dna.size());
-        for (const auto& gene : other.dna) {
-            this->dna.push_back(gene.clone());
-        }
-        
+        this->fitnessInterval = other.fitnessInterval;
+        this->renderCache = other.renderCache;
+        this->cachedPrefix = other.cachedPrefix;
+        this->errorTable = other.errorTable;
+        this->dirty = other.dirty;
+        this->operatorsApplied = other.operatorsApplied;
+        this->parentFitness = other.parentFitness;
+        this->operatorCost = other.operatorCost;
+        this->dna = other.dna;
+
         return *this;
     }
 
-    void add_random_gene(Random& rand, int img_width, int img_height, int max_size, ShapeType shape) {
+    Individual(Individual&&) = default;
+    Individual& operator=(Individual&&) = default;
+
+    // Length (radius or side) is log-uniform in [min_length, max_length]: mostly small genes, few large ones
+    void add_random_gene(Random& rand, int img_width, int img_height, int min_length, int max_length, ShapeType shape) {
         int x = rand.getInt(0, img_width - 1);
         int y = rand.getInt(0, img_height - 1);
 
@@ -49,33 +88,64 @@ public:
             (uint8_t)rand.getInt(0, 100) 
         };
 
-        int s = rand.getInt(1, max_size);
+        int s = rand.getLogInt(min_length, max_length);
         dna.push_back(Gene(x, y, c, shape, s));
+        dirty = dirty.united(dna[dna.size() - 1].bounds());
     }
 
     void delete_random_gene(Random& rand) {
         if (dna.empty()) return;
-        int gene_index = rand.getInt(0, static_cast<int>(dna.size()) - 1);
-        dna.erase(dna.begin() + gene_index);
+        delete_gene(rand.getInt(0, static_cast<int>(dna.size()) - 1));
+    }
+
+    void delete_gene(size_t gene_index) {
+        dirty = dirty.united(dna[gene_index].bounds());
+        dna.erase(gene_index);
+        touchGene(gene_index);
+    }
+
+    void set_gene_length(size_t gene_index, int length) {
+        Gene& gene = dna.mutableAt(gene_index);
+        touchGene(gene_index);
+        dirty = dirty.united(gene.bounds()); // the old extent, which contains the new one
+        gene.setLength(length);
     }
 
-    void mutate_random_gene(Random& rand, int img_width, int img_height) {
+    void mutate_random_gene(Random& rand, int img_width, int img_height, int max_length = INT_MAX) {
         if (dna.empty()) return;
         int gene_index = rand.getInt(0, static_cast<int>(dna.size()) - 1);
-        Gene& gene = dna[gene_index];
-
         // Randomly choose mutation type
-        switch (rand.getInt(0, 2)) {
-            case 0:
+        mutate_gene(gene_index, static_cast<GeneMutation>(rand.getInt(0, 2)), rand, img_width, img_height, max_length);
+    }
+
+    // Same with the kind of change chosen by the caller (e.g. an adaptive operator schedule)
+    void mutate_random_gene(Random& rand, int img_width, int img_height, int max_length, GeneMutation kind) {
+        if (dna.empty()) return;
+        mutate_gene(rand.getInt(0, static_cast<int>(dna.size()) - 1), kind, rand, img_width, img_height, max_length);
+    }
+
+    void mutate_gene(size_t gene_index, GeneMutation kind, Random& rand, int img_width, int img_height, int max_length = INT_MAX) {
+        Gene& gene = dna.mutableAt(gene_index);
+        touchGene(gene_index);
+        dirty = dirty.united(gene.bounds());
+
+        switch (kind) {
+            case GeneMutation::Position:
                 gene.mutatePosition(rand, img_width, img_height);
                 break;
-            case 1:
+            case GeneMutation::Color:
                 gene.mutateColor(rand);
                 break;
-            case 2:
-                gene.mutateLength(rand);
+            case GeneMutation::Length:
+                gene.mutateLength(rand, max_length);
                 break;
         }
+        dirty = dirty.united(gene.bounds());
+    }
+
+    // Marks gene `index` and everything after it as changed for the render cache
+    void touchGene(size_t index) {
+        cachedPrefix = std::min(cachedPrefix, index);
     }
 
 };
\ No newline at end of file
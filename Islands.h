@@ -0,0 +1,57 @@
+// Island model: independent sub-populations on their own threads, exchanging migrants
+#pragma once
+#include "GeneticAlgorithm.h"
+#include "Migration.h"
+#include "ThreadPool.h"
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs `islands` GAs concurrently and returns the best individual found.
+ *
+ * Island i gets a copy of `options` with its own seed (seed + i, when seeded),
+ * its own ThreadPool of threads / islands workers, and the shared
+ * LocalMigrationChannel. runIsland(i, options) builds and runs one
+ * GeneticAlgorithm with them and returns its best individual. Islands never wait
+ * for each other. Each one advances its own generations, and emigrants land in
+ * whatever generation their destination is in when it next checks its mailbox.
+ * The first exception thrown by an island is rethrown after all islands finish.
+ */
+template <typename RunIsland>
+Individual evolveIslands(int islands, unsigned int threads, const GeneticAlgorithmOptions& options, RunIsland runIsland) {
+    islands = std::max(1, islands);
+    LocalMigrationChannel channel(islands);
+    const unsigned int perIsland = std::max(1u, threads / static_cast<unsigned int>(islands));
+
+    std::vector<Individual> best(islands);
+    std::vector<std::exception_ptr> errors(islands);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < islands; ++i) {
+        workers.emplace_back([&, i] {
+            try {
+                ThreadPool pool(perIsland);
+                GeneticAlgorithmOptions islandOptions = options;
+                islandOptions.pool = &pool;
+                islandOptions.migration = islands > 1 ? &channel : nullptr;
+                islandOptions.island = i;
+                if (options.seed != 0) islandOptions.seed = options.seed + static_cast<unsigned int>(i);
+                best[i] = runIsland(i, islandOptions);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    size_t winner = 0;
+    for (size_t i = 1; i < best.size(); ++i) {
+        if (best[i].fitness < best[winner].fitness) winner = i;
+    }
+    return best[winner];
+}
@@ -1,19 +1,64 @@
 // Function that loads an image from a file
 #pragma once
 #include "stb_image.h"
+#include "AlignedBuffer.h"
 #include <string>
-#include <vector>
+#include <memory>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
-struct Pixel { uint8_t r, g, b, a; };
+// The one pixel type: 8-bit RGBA, laid out exactly like stb_image's 4-channel output
+struct Pixel32 { uint8_t r, g, b, a; };
+static_assert(sizeof(Pixel32) == 4, "Pixel32 must match the decoder's RGBA layout");
+
+// Rendered canvases: canvasStride(width) pixels per row, 64-byte aligned, padding kept zero
+typedef std::vector<Pixel32, AlignedAllocator<Pixel32>> PixelBuffer;
+
+inline int canvasStride(int width) { return alignedStride<Pixel32>(width); }
 
 struct Image {
-    int width;
-    int height;
-    std::vector<Pixel> data; // RGBA format
+    int width = 0;
+    int height = 0;
+    int stride = 0; // pixels from one row start to the next (>= width)
+    std::shared_ptr<Pixel32> buffer; // RGBA rows; copies share it, the owner's deleter frees it
+
+    const Pixel32* data() const { return buffer.get(); }
+    Pixel32* mutableData() { return buffer.get(); }
+    const Pixel32* row(int y) const { return buffer.get() + static_cast<size_t>(y) * stride; }
+    const Pixel32& at(int x, int y) const { return row(y)[x]; }
+    size_t size() const { return static_cast<size_t>(width) * height; }
+    // Same row layout as a canvas of this width, so kernels can run over both buffers flat
+    bool canvasLayout() const {
+        return stride == canvasStride(width) && reinterpret_cast<uintptr_t>(buffer.get()) % PIXEL_ROW_ALIGN == 0;
+    }
 };
 
+// Zeroed, canvas-layout image (aligned rows, zero padding)
+inline Image allocateImage(int width, int height) {
+    Image img;
+    img.width = width;
+    img.height = height;
+    img.stride = canvasStride(width);
+    const size_t count = static_cast<size_t>(img.stride) * height;
+    Pixel32* pixels = AlignedAllocator<Pixel32>().allocate(count);
+    std::memset(pixels, 0, count * sizeof(Pixel32));
+    img.buffer = std::shared_ptr<Pixel32>(pixels, [count](Pixel32* p) { AlignedAllocator<Pixel32>().deallocate(p, count); });
+    return img;
+}
+
+// The image itself when it already has canvas layout, otherwise an aligned, padded copy
+inline Image alignedImage(const Image& src) {
+    if (src.canvasLayout()) return src;
+    Image img = allocateImage(src.width, src.height);
+    for (int y = 0; y < src.height; ++y) {
+        std::memcpy(img.mutableData() + static_cast<size_t>(y) * img.stride, src.row(y), static_cast<size_t>(src.width) * sizeof(Pixel32));
+    }
+    return img;
+}
+
+// Adopts stb_image's buffer as-is (stride == width); it is released with stbi_image_free when the last copy goes
 inline Image loadImage(const std::string& filename) {
     Image img;
     int channels;
@@ -21,11 +66,20 @@ inline Image loadImage(const std::string& filename) {
     if (!data) {
         throw std::runtime_error("Failed to load image");
     }
-    img.data.reserve(img.width * img.height);
-    for (int i = 0; i < img.width * img.height * 4; i += 4) {
-        Pixel pixel = { data[i], data[i + 1], data[i + 2], data[i + 3] };
-        img.data.push_back(pixel);
+    img.stride = img.width;
+    img.buffer = std::shared_ptr<Pixel32>(reinterpret_cast<Pixel32*>(data), [](Pixel32* p) { stbi_image_free(p); });
+    return img;
+}
+
+// Same as loadImage for an encoded file already in memory
+inline Image loadImageFromMemory(const uint8_t* bytes, size_t size) {
+    Image img;
+    int channels;
+    stbi_uc* data = stbi_load_from_memory(bytes, static_cast<int>(size), &img.width, &img.height, &channels, 4);
+    if (!data) {
+        throw std::runtime_error("Failed to load image");
     }
-    stbi_image_free(data);
+    img.stride = img.width;
+    img.buffer = std::shared_ptr<Pixel32>(reinterpret_cast<Pixel32*>(data), [](Pixel32* p) { stbi_image_free(p); });
     return img;
 }
@@ -0,0 +1,111 @@
+// Migration between island sub-populations: channel interface, lock-free mailboxes, topologies
+#pragma once
+#include "Individual.h"
+#include "RandomHelper.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+enum class MigrationTopology {
+    Ring,   // island i sends to i + 1
+    All,    // every island sends to every other island
+    Random  // one other island picked afresh at every exchange
+};
+
+// Islands that `island` sends its emigrants to under `topology`
+inline std::vector<int> migrationTargets(MigrationTopology topology, int island, int islands, Random& rand) {
+    std::vector<int> targets;
+    if (islands < 2) return targets;
+    switch (topology) {
+        case MigrationTopology::Ring:
+            targets.push_back((island + 1) % islands);
+            break;
+        case MigrationTopology::All:
+            for (int i = 0; i < islands; ++i) {
+                if (i != island) targets.push_back(i);
+            }
+            break;
+        case MigrationTopology::Random: {
+            int pick = rand.getInt(0, islands - 2);
+            targets.push_back(pick >= island ? pick + 1 : pick);
+            break;
+        }
+    }
+    return targets;
+}
+
+/**
+ * @brief Moves individuals between islands.
+ *
+ * send() never blocks and receive() returns whatever has arrived so far, so
+ * islands never wait for each other. LocalMigrationChannel connects islands that
+ * are threads of one process. An implementation for islands in other processes
+ * only has to carry encodeGenome() records (GenomeIO.h) over a socket or a
+ * shared-memory ring and decode them in receive().
+ */
+class MigrationChannel {
+public:
+    virtual ~MigrationChannel() = default;
+    virtual int islands() const = 0;
+    virtual void send(int island, const Individual& individual) = 0;
+    virtual std::vector<Individual> receive(int island) = 0;
+};
+
+/**
+ * @brief Multi-producer, single-consumer inbox: a Treiber stack drained whole.
+ *
+ * Senders push with one compare-and-swap. The owner takes the entire list with
+ * one exchange, so nodes are never popped individually and there is no ABA
+ * hazard. Copies of individuals are cheap: DNA chunks, render checkpoints and
+ * error tables are shared copy-on-write.
+ */
+class MigrationMailbox {
+public:
+    MigrationMailbox() = default;
+    MigrationMailbox(const MigrationMailbox&) = delete;
+    MigrationMailbox& operator=(const MigrationMailbox&) = delete;
+    ~MigrationMailbox() { drain(); }
+
+    void push(const Individual& individual) {
+        Node* node = new Node{individual, head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Everything pushed so far, oldest first
+    std::vector<Individual> drain() {
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+        std::vector<Individual> out;
+        while (node) {
+            out.push_back(std::move(node->individual));
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+        std::reverse(out.begin(), out.end());
+        return out;
+    }
+
+private:
+    struct Node {
+        Individual individual;
+        Node* next;
+    };
+    std::atomic<Node*> head{nullptr};
+};
+
+// Islands running as threads of this process, one mailbox each
+class LocalMigrationChannel : public MigrationChannel {
+public:
+    explicit LocalMigrationChannel(int islands) {
+        for (int i = 0; i < islands; ++i) mailboxes.push_back(std::make_unique<MigrationMailbox>());
+    }
+
+    int islands() const override { return static_cast<int>(mailboxes.size()); }
+    void send(int island, const Individual& individual) override { mailboxes[island]->push(individual); }
+    std::vector<Individual> receive(int island) override { return mailboxes[island]->drain(); }
+
+private:
+    std::vector<std::unique_ptr<MigrationMailbox>> mailboxes;
+};
@@ -0,0 +1,132 @@
+// Adaptive mutation operator selection: a bandit over the operators, rewarding improvement per unit of scoring work
+#pragma once
+#include "RandomHelper.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+enum class MutationOperator {
+    Position, // move a random gene
+    Color,    // nudge a random gene's RGBA
+    Length,   // grow or shrink a random gene
+    Add,      // insert a new random gene
+    Delete    // remove a random gene
+};
+
+static const int MUTATION_OPERATORS = 5;
+
+inline const char* mutationOperatorName(MutationOperator op) {
+    static const char* names[MUTATION_OPERATORS] = {"position", "color", "length", "add", "delete"};
+    return names[static_cast<int>(op)];
+}
+
+/**
+ * @brief Picks mutation operators in proportion to their recent payoff rate.
+ *
+ * Every outcome reports an operator's fitness improvement (0 when it did not
+ * help) and its cost in pixels rendered and scored. Per operator,
+ * exponentially weighted averages of both track recent behaviour, and their
+ * ratio is the improvement per pixel of work. Selection probabilities follow those rates (probability
+ * matching). A floor keeps every operator explored, so one that starts paying
+ * off again is noticed. Until each operator has warmupRecords outcomes the
+ * choice is uniform.
+ *
+ * select() and record() lock, so the steady-state and hill-climbing threads can
+ * share one scheduler. Probabilities change only in record(), so a caller that
+ * selects in parallel and records in a fixed order stays deterministic.
+ */
+class OperatorScheduler {
+public:
+    explicit OperatorScheduler(double minProbability = 0.05, double smoothing = 0.02, int warmupRecords = 20)
+        : minProbability(std::clamp(minProbability, 0.0, 1.0 / MUTATION_OPERATORS)), smoothing(smoothing), warmupRecords(warmupRecords) {
+        probabilities.fill(1.0 / MUTATION_OPERATORS);
+    }
+
+    MutationOperator select(Random& rand) const {
+        const double u = rand.getDouble(0.0, 1.0);
+        std::lock_guard<std::mutex> lock(mutex);
+        double sum = 0.0;
+        for (int i = 0; i < MUTATION_OPERATORS - 1; ++i) {
+            sum += probabilities[i];
+            if (u < sum) return static_cast<MutationOperator>(i);
+        }
+        return static_cast<MutationOperator>(MUTATION_OPERATORS - 1);
+    }
+
+    // improvement: fitness gained (0 if none); cost: pixels rendered and scored to evaluate the change
+    void record(MutationOperator op, double improvement, double cost) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Arm& arm = arms[static_cast<int>(op)];
+        const double a = arm.records == 0 ? 1.0 : smoothing;
+        arm.gain += a * (std::max(0.0, improvement) - arm.gain);
+        arm.cost += a * (std::max(1.0, cost) - arm.cost);
+        ++arm.records;
+        updateProbabilities();
+    }
+
+    // Arm statistics as text, for checkpoints; restoreState() continues the same schedule
+    std::string saveState() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ostringstream out;
+        out.precision(17);
+        for (const Arm& arm : arms) out << arm.gain << ' ' << arm.cost << ' ' << arm.records << ' ';
+        return out.str();
+    }
+
+    bool restoreState(const std::string& state) {
+        std::istringstream in(state);
+        std::array<Arm, MUTATION_OPERATORS> restored{};
+        for (Arm& arm : restored) in >> arm.gain >> arm.cost >> arm.records;
+        if (in.fail()) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        arms = restored;
+        probabilities.fill(1.0 / MUTATION_OPERATORS);
+        updateProbabilities();
+        return true;
+    }
+
+    // Current selection probabilities, e.g. "position 31% color 12% ..."
+    std::string summary() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string out;
+        char item[32];
+        for (int i = 0; i < MUTATION_OPERATORS; ++i) {
+            std::snprintf(item, sizeof(item), "%s%s %.0f%%", i ? " " : "", mutationOperatorName(static_cast<MutationOperator>(i)), probabilities[i] * 100.0);
+            out += item;
+        }
+        return out;
+    }
+
+private:
+    struct Arm {
+        double gain = 0.0; // smoothed improvement per use
+        double cost = 0.0; // smoothed pixels per use
+        long long records = 0;
+    };
+
+    double minProbability;
+    double smoothing;
+    int warmupRecords;
+    std::array<Arm, MUTATION_OPERATORS> arms{};
+    std::array<double, MUTATION_OPERATORS> probabilities{};
+    mutable std::mutex mutex;
+
+    void updateProbabilities() {
+        std::array<double, MUTATION_OPERATORS> rates{};
+        double total = 0.0;
+        for (int i = 0; i < MUTATION_OPERATORS; ++i) {
+            if (arms[i].records < warmupRecords) return; // not enough evidence yet: stay uniform
+            rates[i] = arms[i].gain / arms[i].cost;
+            total += rates[i];
+        }
+        if (!(total > 0.0)) {
+            probabilities.fill(1.0 / MUTATION_OPERATORS);
+            return;
+        }
+        const double share = 1.0 - MUTATION_OPERATORS * minProbability;
+        for (int i = 0; i < MUTATION_OPERATORS; ++i) probabilities[i] = minProbability + share * rates[i] / total;
+    }
+};
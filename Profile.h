@@ -0,0 +1,246 @@
+// Scoped phase timers with per-thread histograms and Chrome trace export (GENETICART_PROFILE builds only)
+#pragma once
+
+/*
+ * GA_PROFILE_SCOPE("name") times the rest of the enclosing block. Without
+ * GENETICART_PROFILE it expands to nothing, so instrumented code costs nothing
+ * in normal builds. With it, each scope reads the timestamp counter twice
+ * (RDTSC on x86, steady_clock elsewhere) and writes thread-local memory only:
+ * one log-scale histogram bucket plus one trace event. There are no locks or shared
+ * atomics on the hot path.
+ *
+ * profileReport() and profileWriteChromeTrace() read every thread's data. Call
+ * them while the instrumented threads are idle, e.g. between generations
+ * (ThreadPool::parallelFor has returned) or after the run.
+ */
+#if defined(GENETICART_PROFILE)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GENETICART_PROFILE_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define GENETICART_PROFILE_RDTSC 1
+#endif
+
+static const int PROFILE_MAX_PHASES = 64;
+static const int PROFILE_BUCKETS = 256;                // four per power of two of ticks, see profileBucket()
+static const size_t PROFILE_MAX_EVENTS = size_t(1) << 18; // per thread; later events only reach the histograms
+
+inline uint64_t profileTicks() {
+#if defined(GENETICART_PROFILE_RDTSC)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Log-linear bucket: exact below 4 ticks, then the top two bits after the leading one (<= 25% wide)
+inline int profileBucket(uint64_t ticks) {
+    if (ticks < 4) return static_cast<int>(ticks);
+    int msb = 63;
+#if defined(__GNUC__) || defined(__clang__)
+    msb -= __builtin_clzll(ticks);
+#else
+    while (!(ticks >> msb)) --msb;
+#endif
+    return msb * 4 + static_cast<int>((ticks >> (msb - 2)) & 3);
+}
+
+// Smallest duration that falls past bucket b
+inline double profileBucketEnd(int b) {
+    if (b < 4) return b + 1.0;
+    return std::ldexp(4.0 + b % 4 + 1.0, b / 4 - 2);
+}
+
+struct ProfileHistogram {
+    uint64_t count = 0;
+    uint64_t totalTicks = 0;
+    uint64_t minTicks = UINT64_MAX;
+    uint64_t maxTicks = 0;
+    uint64_t buckets[PROFILE_BUCKETS] = {};
+};
+
+struct ProfileEvent {
+    uint32_t phase;
+    uint64_t start, ticks;
+};
+
+struct ProfileThread {
+    int id;
+    ProfileHistogram phases[PROFILE_MAX_PHASES];
+    std::vector<ProfileEvent> events;
+    uint64_t droppedEvents = 0;
+};
+
+/**
+ * @brief Process-wide registry of phase names and per-thread records.
+ *
+ * Threads register once, on their first timed scope. Records outlive their
+ * threads, so pool workers and the snapshot writer can be reported after they exit.
+ */
+class Profiler {
+public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    // Called once per scope site (function-local static), so the lock is off the hot path
+    int phaseId(const char* name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (std::strcmp(names[i], name) == 0) return static_cast<int>(i);
+        }
+        if (names.size() >= PROFILE_MAX_PHASES) return PROFILE_MAX_PHASES - 1; // shares the last slot
+        names.push_back(name);
+        return static_cast<int>(names.size()) - 1;
+    }
+
+    ProfileThread& thread() {
+        thread_local ProfileThread* local = nullptr;
+        if (!local) {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.push_back(std::make_unique<ProfileThread>());
+            local = threads.back().get();
+            local->id = static_cast<int>(threads.size()) - 1;
+            local->events.reserve(4096);
+        }
+        return *local;
+    }
+
+    // Timestamp-counter ticks per nanosecond, measured against steady_clock since startup
+    double ticksPerNs() const {
+#if defined(GENETICART_PROFILE_RDTSC)
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+        uint64_t ticks = profileTicks() - startTicks;
+        return ns > 0 && ticks > 0 ? static_cast<double>(ticks) / static_cast<double>(ns) : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+
+    // Per phase and thread: calls, total, mean, approximate p50/p99 and max, in milliseconds
+    void report(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const double toMs = 1.0 / (ticksPerNs() * 1e6);
+        char line[192];
+        std::snprintf(line, sizeof(line), "%-24s %6s %10s %12s %10s %10s %10s %10s\n", "phase", "thread", "calls", "total ms", "mean ms",
+                      "p50 ms", "p99 ms", "max ms");
+        out << line;
+        for (size_t p = 0; p < names.size(); ++p) {
+            for (const auto& t : threads) {
+                const ProfileHistogram& h = t->phases[p];
+                if (h.count == 0) continue;
+                std::snprintf(line, sizeof(line), "%-24s %6d %10llu %12.3f %10.4f %10.4f %10.4f %10.4f\n", names[p], t->id,
+                              static_cast<unsigned long long>(h.count), h.totalTicks * toMs, h.totalTicks * toMs / h.count,
+                              percentile(h, 0.50) * toMs, percentile(h, 0.99) * toMs, h.maxTicks * toMs);
+                out << line;
+            }
+        }
+        for (const auto& t : threads) {
+            if (t->droppedEvents) out << "thread " << t->id << ": " << t->droppedEvents << " trace events dropped (buffer full)\n";
+        }
+        out.flush();
+    }
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto): one complete ("X") event per scope
+    bool writeChromeTrace(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ofstream out(path);
+        if (!out) return false;
+        const double toUs = 1.0 / (ticksPerNs() * 1e3);
+        out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+        bool first = true;
+        char line[256];
+        for (const auto& t : threads) {
+            for (const ProfileEvent& e : t->events) {
+                std::snprintf(line, sizeof(line), "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                              first ? "" : ",", names[e.phase], t->id, (e.start - startTicks) * toUs, e.ticks * toUs);
+                out << line;
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<const char*> names;
+    std::vector<std::unique_ptr<ProfileThread>> threads;
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    const uint64_t startTicks = profileTicks();
+
+    // Upper edge of the bucket holding the q-quantile, in ticks
+    static double percentile(const ProfileHistogram& h, double q) {
+        uint64_t target = static_cast<uint64_t>(q * static_cast<double>(h.count - 1)) + 1, seen = 0;
+        for (int b = 0; b < PROFILE_BUCKETS; ++b) {
+            seen += h.buckets[b];
+            if (seen >= target) return std::min(static_cast<double>(h.maxTicks), profileBucketEnd(b));
+        }
+        return static_cast<double>(h.maxTicks);
+    }
+};
+
+// Records one scope on the calling thread's histogram and trace buffer
+class ProfileScope {
+public:
+    explicit ProfileScope(int phase) : phase(phase), start(profileTicks()) {}
+
+    ~ProfileScope() {
+        const uint64_t ticks = profileTicks() - start;
+        ProfileThread& t = Profiler::instance().thread();
+        ProfileHistogram& h = t.phases[phase];
+        ++h.count;
+        h.totalTicks += ticks;
+        h.minTicks = std::min(h.minTicks, ticks);
+        h.maxTicks = std::max(h.maxTicks, ticks);
+        ++h.buckets[profileBucket(ticks)];
+        if (t.events.size() < PROFILE_MAX_EVENTS) t.events.push_back(ProfileEvent{static_cast<uint32_t>(phase), start, ticks});
+        else ++t.droppedEvents;
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    int phase;
+    uint64_t start;
+};
+
+#define GA_PROFILE_CONCAT_(a, b) a##b
+#define GA_PROFILE_CONCAT(a, b) GA_PROFILE_CONCAT_(a, b)
+#define GA_PROFILE_SCOPE(name)                                                                             \
+    static const int GA_PROFILE_CONCAT(ga_profile_phase_, __LINE__) = Profiler::instance().phaseId(name); \
+    ProfileScope GA_PROFILE_CONCAT(ga_profile_scope_, __LINE__)(GA_PROFILE_CONCAT(ga_profile_phase_, __LINE__))
+
+inline void profileReport(std::ostream& out) { Profiler::instance().report(out); }
+inline bool profileWriteChromeTrace(const std::string& path) { return Profiler::instance().writeChromeTrace(path); }
+static const bool PROFILE_ENABLED = true;
+
+#else
+
+#include <ostream>
+#include <string>
+
+#define GA_PROFILE_SCOPE(name) ((void)0)
+
+inline void profileReport(std::ostream&) {}
+inline bool profileWriteChromeTrace(const std::string&) { return false; }
+static const bool PROFILE_ENABLED = false;
+
+#endif
@@ -0,0 +1,45 @@
+// Mip pyramid of the target image used for coarse-to-fine evolution
+#pragma once
+#include "Render.h"
+#include <vector>
+
+// A level is a canvas-layout Image (so level 0 can share the caller's target buffer) plus its scale
+struct PyramidLevel : Image {
+    double scale; // gene coordinates and lengths are multiplied by this to land on the level
+};
+
+// 2x2 box filter; odd edges reuse the last row/column
+inline PyramidLevel downsampleLevel(const PyramidLevel& src) {
+    PyramidLevel dst{allocateImage((src.width + 1) / 2, (src.height + 1) / 2), src.scale * 0.5};
+    Pixel32* pixels = dst.mutableData();
+    for (int y = 0; y < dst.height; ++y) {
+        int sy0 = 2 * y, sy1 = std::min(2 * y + 1, src.height - 1);
+        for (int x = 0; x < dst.width; ++x) {
+            int sx0 = 2 * x, sx1 = std::min(2 * x + 1, src.width - 1);
+            const Pixel32& a = src.at(sx0, sy0);
+            const Pixel32& b = src.at(sx1, sy0);
+            const Pixel32& c = src.at(sx0, sy1);
+            const Pixel32& d = src.at(sx1, sy1);
+            Pixel32& out = pixels[static_cast<size_t>(y) * dst.stride + x];
+            out.r = static_cast<uint8_t>((a.r + b.r + c.r + d.r + 2) / 4);
+            out.g = static_cast<uint8_t>((a.g + b.g + c.g + d.g + 2) / 4);
+            out.b = static_cast<uint8_t>((a.b + b.b + c.b + d.b + 2) / 4);
+            out.a = static_cast<uint8_t>((a.a + b.a + c.a + d.a + 2) / 4);
+        }
+    }
+    return dst;
+}
+
+// Level 0 is the full-resolution target itself, shared when it already has canvas layout (else one
+// aligned copy); each further level halves both dimensions. Stops early once a level would drop
+// below 2 pixels on either side.
+inline std::vector<PyramidLevel> buildPyramid(const Image& target, int coarseLevels) {
+    std::vector<PyramidLevel> pyramid;
+    pyramid.push_back(PyramidLevel{alignedImage(target), 1.0});
+    for (int i = 0; i < coarseLevels; ++i) {
+        const PyramidLevel& prev = pyramid.back();
+        if (prev.width < 4 || prev.height < 4) break;
+        pyramid.push_back(downsampleLevel(prev));
+    }
+    return pyramid;
+}
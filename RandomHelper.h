@@ -1,5 +1,9 @@
 #pragma once
 #include <random>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
 
 
 /**
@@ -17,6 +21,31 @@ public:
      */
     Random() : gen(rd()) {} // Seed the generator
 
+    /**
+     * @brief Constructor: Seeds the engine with a fixed value for reproducible runs.
+     */
+    explicit Random(unsigned int seed) : gen(seed) {}
+
+    /**
+     * @brief Re-seed the engine in place (Random itself is not copyable).
+     */
+    void seed(unsigned int value) { gen.seed(value); }
+
+    /**
+     * @brief Full engine state as text, for checkpoints; restoreState() resumes the exact sequence.
+     */
+    std::string saveState() const {
+        std::ostringstream out;
+        out << gen;
+        return out.str();
+    }
+
+    bool restoreState(const std::string& state) {
+        std::istringstream in(state);
+        in >> gen;
+        return !in.fail();
+    }
+
     /**
      * @brief Get a random integer in the inclusive range [min, max].
      */
@@ -36,6 +65,17 @@ public:
         return dis(gen);
     }
 
+    /**
+     * @brief Get a random integer in [min, max] (min >= 1) with a log-uniform distribution:
+     * every octave of the range is equally likely, so small values dominate wide ranges.
+     */
+    int getLogInt(int min, int max) {
+        min = std::max(1, min);
+        if (max <= min) return min;
+        double v = std::exp(getDouble(std::log(static_cast<double>(min)), std::log(max + 1.0)));
+        return std::clamp(static_cast<int>(v), min, max);
+    }
+
 private:
     std::random_device rd;  // Hardware-based non-deterministic seed
     std::mt19937 gen;       // The high-quality random number engine
@@ -0,0 +1,491 @@
+// Distributed fitness evaluation: worker processes score GADN genomes sent over TCP or Unix sockets
+#pragma once
+#include "GenomeIO.h"
+#include "Pyramid.h"
+#include "Render.h"
+#include "ThreadPool.h"
+#include "Profile.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Evaluation protocol (little-endian, version 1). A coordinator opens one connection per worker:
+ *
+ *   hello   coordinator -> worker, 32 bytes: magic "GAEV", version, target width, height, blend
+ *           mode, coarse pyramid levels, FNV-1a 64 hash of the target's visible RGBA rows
+ *   ready   worker -> coordinator, 16 bytes: magic "GAEV", version, status (0 = ready, 1 = the
+ *           worker holds a different target), pyramid levels the worker built
+ *   batch   coordinator -> worker: uint32 batch id, genome count, pyramid level, payload bytes,
+ *           then the genomes as back-to-back GADN records (GenomeIO.h)
+ *   scores  worker -> coordinator: uint32 batch id, genome count, then one IEEE double per genome,
+ *           the value exact scoring would give on the coordinator (-1 for an unreadable record)
+ *
+ * Workers answer batches in arrival order, so the coordinator keeps several in flight per
+ * connection and never idles a worker for a round trip. Only genomes cross the wire (16 bytes
+ * a gene); every worker loads the target itself. Addresses are "unix:/path" or "host:port".
+ */
+static const char REMOTE_MAGIC[4] = {'G', 'A', 'E', 'V'};
+static const uint32_t REMOTE_VERSION = 1;
+static const size_t REMOTE_HELLO_SIZE = 32;
+static const size_t REMOTE_READY_SIZE = 16;
+static const size_t REMOTE_BATCH_HEADER_SIZE = 16;
+static const uint32_t REMOTE_MAX_PAYLOAD = 1u << 30;
+
+static inline void remote_put64(uint8_t* p, uint64_t v) {
+    genome_put32(p, static_cast<uint32_t>(v));
+    genome_put32(p + 4, static_cast<uint32_t>(v >> 32));
+}
+
+static inline uint64_t remote_get64(const uint8_t* p) {
+    return genome_get32(p) | (static_cast<uint64_t>(genome_get32(p + 4)) << 32);
+}
+
+// Identifies the target both ends score against; padding and stride do not take part
+inline uint64_t remoteTargetHash(const Image& target) {
+    uint64_t h = 14695981039346656037ull;
+    for (int y = 0; y < target.height; ++y) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(target.row(y));
+        for (size_t i = 0; i < static_cast<size_t>(target.width) * sizeof(Pixel32); ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    }
+    return h;
+}
+
+// Exact fitness on one pyramid level, scaled to the full-resolution pixel count (as GeneticAlgorithm scores)
+inline double remoteScore(const PyramidLevel& level, int fullWidth, int fullHeight, const Individual& individual, BlendMode mode) {
+    thread_local PixelBuffer pixels;
+    renderIndividualInto(level.width, level.height, individual, mode, pixels, level.scale);
+    double error = static_cast<double>(pixelAbsDiffSum(level.data(), pixels.data(), pixels.size()));
+    return error * (static_cast<double>(fullWidth) * fullHeight) / level.size();
+}
+
+#if !defined(_WIN32)
+
+inline bool remote_send_all(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+#if defined(MSG_NOSIGNAL)
+        ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+#else
+        ssize_t n = ::send(fd, p, size, 0);
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// False when the peer closed the connection or failed before `size` bytes arrived
+inline bool remote_recv_all(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = ::recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline void remote_tune_socket(int fd, bool tcp) {
+    int one = 1;
+    if (tcp) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // batches are latency-bound
+#if defined(SO_NOSIGPIPE)
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+// Connected (or, with `listening`, bound and listening) socket for an address; -1 with `error` set on failure
+inline int remote_open(const std::string& address, bool listening, std::string& error) {
+    if (address.compare(0, 5, "unix:") == 0) {
+        const std::string path = address.substr(5);
+        sockaddr_un addr{};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            error = "bad socket path in " + address;
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            error = std::strerror(errno);
+            return -1;
+        }
+        if (listening) ::unlink(path.c_str()); // a stale socket file from an earlier worker
+        int rc = listening ? ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))
+                           : ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        if (rc != 0 || (listening && ::listen(fd, 16) != 0)) {
+            error = address + ": " + std::strerror(errno);
+            ::close(fd);
+            return -1;
+        }
+        if (!listening) remote_tune_socket(fd, false);
+        return fd;
+    }
+
+    const size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        error = "expected host:port or unix:path, got " + address;
+        return -1;
+    }
+    std::string host = address.substr(0, colon);
+    const std::string port = address.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (listening) hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    int rc = ::getaddrinfo(host.empty() || host == "*" ? nullptr : host.c_str(), port.c_str(), &hints, &found);
+    if (rc != 0) {
+        error = address + ": " + gai_strerror(rc);
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* ai = found; ai && fd < 0; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        int one = 1;
+        if (listening) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        bool ok = listening ? ::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, 16) == 0
+                            : ::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0;
+        if (!ok) {
+            error = address + ": " + std::strerror(errno);
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(found);
+    if (fd >= 0 && !listening) remote_tune_socket(fd, true);
+    return fd;
+}
+
+#endif
+
+/**
+ * @brief Coordinator side: scores individuals on a set of worker processes.
+ *
+ * evaluate() cuts its input into batches of batchSize genomes and keeps up to
+ * pipelineDepth batches in flight on every worker, handing the next batch to
+ * whichever worker answers first, so faster machines take more of the work.
+ * When a worker disconnects, its unanswered batches go to the others. Only when
+ * none are left does evaluate() throw. Calls are serialized, so islands can share
+ * one evaluator.
+ */
+class RemoteEvaluator {
+public:
+    RemoteEvaluator(const std::vector<std::string>& addresses, const Image& target, int pyramidLevels, BlendMode mode,
+                    int batchSize = 16, int pipelineDepth = 2)
+        : width(target.width), height(target.height), mode(mode), batchSize(std::max(1, batchSize)),
+          pipelineDepth(std::max(1, pipelineDepth)) {
+#if defined(_WIN32)
+        (void)addresses;
+        (void)pyramidLevels;
+        throw std::runtime_error("Remote evaluation needs POSIX sockets");
+#else
+        uint8_t hello[REMOTE_HELLO_SIZE];
+        std::memcpy(hello, REMOTE_MAGIC, 4);
+        genome_put32(hello + 4, REMOTE_VERSION);
+        genome_put32(hello + 8, static_cast<uint32_t>(width));
+        genome_put32(hello + 12, static_cast<uint32_t>(height));
+        genome_put32(hello + 16, static_cast<uint32_t>(mode));
+        genome_put32(hello + 20, static_cast<uint32_t>(std::max(0, pyramidLevels)));
+        remote_put64(hello + 24, remoteTargetHash(target));
+        const size_t expectedLevels = buildPyramidLevelCount(target.width, target.height, pyramidLevels);
+
+        for (const auto& address : addresses) {
+            std::string error;
+            int fd = remote_open(address, false, error);
+            if (fd < 0) {
+                closeAll();
+                throw std::runtime_error("Cannot reach worker " + error);
+            }
+            connections.push_back(Connection{fd, address, {}});
+            uint8_t ready[REMOTE_READY_SIZE];
+            if (!remote_send_all(fd, hello, sizeof(hello)) || !remote_recv_all(fd, ready, sizeof(ready))
+                || std::memcmp(ready, REMOTE_MAGIC, 4) != 0 || genome_get32(ready + 4) != REMOTE_VERSION) {
+                closeAll();
+                throw std::runtime_error("Worker " + address + " does not speak the evaluation protocol");
+            }
+            if (genome_get32(ready + 8) != 0 || genome_get32(ready + 12) != expectedLevels) {
+                closeAll();
+                throw std::runtime_error("Worker " + address + " holds a different target image");
+            }
+        }
+        if (connections.empty()) throw std::runtime_error("No evaluation workers given");
+#endif
+    }
+
+    ~RemoteEvaluator() { closeAll(); }
+
+    RemoteEvaluator(const RemoteEvaluator&) = delete;
+    RemoteEvaluator& operator=(const RemoteEvaluator&) = delete;
+
+    // Sets fitness (and a zero interval) on every individual, scored at the given pyramid level
+    void evaluate(const std::vector<Individual*>& individuals, int level) {
+#if !defined(_WIN32)
+        GA_PROFILE_SCOPE("evaluateRemote");
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t batches = (individuals.size() + batchSize - 1) / batchSize;
+        std::deque<size_t> pending;
+        for (size_t b = 0; b < batches; ++b) pending.push_back(b);
+        size_t answered = 0;
+
+        std::vector<pollfd> polls;
+        std::vector<Connection*> polled;
+        while (answered < batches) {
+            polls.clear();
+            polled.clear();
+            for (auto& c : connections) {
+                while (c.fd >= 0 && c.inFlight.size() < static_cast<size_t>(pipelineDepth) && !pending.empty()) {
+                    if (!sendBatch(c, individuals, pending.front(), level)) {
+                        drop(c, pending);
+                        break;
+                    }
+                    c.inFlight.push_back(pending.front());
+                    pending.pop_front();
+                }
+                if (c.fd >= 0 && !c.inFlight.empty()) {
+                    polls.push_back(pollfd{c.fd, POLLIN, 0});
+                    polled.push_back(&c);
+                }
+            }
+            if (polls.empty()) throw std::runtime_error("All evaluation workers disconnected");
+
+            if (::poll(polls.data(), static_cast<nfds_t>(polls.size()), -1) < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+            }
+            for (size_t i = 0; i < polls.size(); ++i) {
+                if (!polls[i].revents) continue;
+                Connection& c = *polled[i];
+                if (receiveScores(c, individuals)) {
+                    c.inFlight.pop_front();
+                    ++answered;
+                } else {
+                    drop(c, pending);
+                }
+            }
+        }
+#else
+        (void)individuals;
+        (void)level;
+#endif
+    }
+
+    size_t workers() const {
+        size_t live = 0;
+        for (const auto& c : connections) live += c.fd >= 0;
+        return live;
+    }
+
+private:
+    struct Connection {
+        int fd;
+        std::string address;
+        std::deque<size_t> inFlight; // batch indices, in the order the worker will answer them
+    };
+
+    int width, height;
+    BlendMode mode;
+    int batchSize, pipelineDepth;
+    std::vector<Connection> connections;
+    std::vector<uint8_t> sendBuffer;
+    std::vector<uint8_t> receiveBuffer;
+    std::mutex mutex;
+
+    // Mirrors buildPyramid's stopping rule, so a worker that built other levels is caught up front
+    static size_t buildPyramidLevelCount(int w, int h, int coarseLevels) {
+        size_t levels = 1;
+        for (int i = 0; i < coarseLevels && w >= 4 && h >= 4; ++i) {
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+            ++levels;
+        }
+        return levels;
+    }
+
+#if !defined(_WIN32)
+    bool sendBatch(Connection& c, const std::vector<Individual*>& individuals, size_t batch, int level) {
+        const size_t first = batch * batchSize;
+        const size_t count = std::min(individuals.size() - first, static_cast<size_t>(batchSize));
+        sendBuffer.assign(REMOTE_BATCH_HEADER_SIZE, 0);
+        for (size_t i = first; i < first + count; ++i) {
+            std::vector<uint8_t> record = encodeGenome(*individuals[i], width, height, mode);
+            sendBuffer.insert(sendBuffer.end(), record.begin(), record.end());
+        }
+        genome_put32(sendBuffer.data(), static_cast<uint32_t>(batch));
+        genome_put32(sendBuffer.data() + 4, static_cast<uint32_t>(count));
+        genome_put32(sendBuffer.data() + 8, static_cast<uint32_t>(level));
+        genome_put32(sendBuffer.data() + 12, static_cast<uint32_t>(sendBuffer.size() - REMOTE_BATCH_HEADER_SIZE));
+        return remote_send_all(c.fd, sendBuffer.data(), sendBuffer.size());
+    }
+
+    bool receiveScores(Connection& c, const std::vector<Individual*>& individuals) {
+        uint8_t header[8];
+        if (!remote_recv_all(c.fd, header, sizeof(header))) return false;
+        const size_t batch = c.inFlight.front();
+        const size_t first = batch * batchSize;
+        const size_t count = std::min(individuals.size() - first, static_cast<size_t>(batchSize));
+        if (genome_get32(header) != static_cast<uint32_t>(batch) || genome_get32(header + 4) != count) return false;
+        receiveBuffer.resize(count * 8);
+        if (!remote_recv_all(c.fd, receiveBuffer.data(), receiveBuffer.size())) return false;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t bits = remote_get64(receiveBuffer.data() + 8 * i);
+            double fitness;
+            std::memcpy(&fitness, &bits, sizeof(fitness));
+            if (fitness < 0.0) throw std::runtime_error("Worker " + c.address + " could not read a genome");
+            individuals[first + i]->fitness = fitness;
+            individuals[first + i]->fitnessInterval = 0.0;
+        }
+        return true;
+    }
+
+    // Gives up on a worker; its unanswered batches go back to the front of the queue
+    void drop(Connection& c, std::deque<size_t>& pending) {
+        std::cerr << "Evaluation worker " << c.address << " disconnected" << std::endl;
+        ::close(c.fd);
+        c.fd = -1;
+        pending.insert(pending.begin(), c.inFlight.begin(), c.inFlight.end());
+        c.inFlight.clear();
+    }
+#endif
+
+    void closeAll() {
+#if !defined(_WIN32)
+        for (auto& c : connections) {
+            if (c.fd >= 0) ::close(c.fd);
+            c.fd = -1;
+        }
+#endif
+    }
+};
+
+#if !defined(_WIN32)
+// One coordinator connection: handshake, then score batches until the coordinator hangs up
+inline void remote_serve_connection(int fd, const Image& target, uint64_t targetHash, ThreadPool& pool, std::mutex& poolMutex) {
+    uint8_t hello[REMOTE_HELLO_SIZE];
+    if (!remote_recv_all(fd, hello, sizeof(hello)) || std::memcmp(hello, REMOTE_MAGIC, 4) != 0
+        || genome_get32(hello + 4) != REMOTE_VERSION || genome_get32(hello + 16) > static_cast<uint32_t>(BlendMode::Overwrite)) {
+        ::close(fd);
+        return;
+    }
+    const BlendMode mode = static_cast<BlendMode>(genome_get32(hello + 16));
+    const bool same = genome_get32(hello + 8) == static_cast<uint32_t>(target.width) && genome_get32(hello + 12) == static_cast<uint32_t>(target.height)
+                      && remote_get64(hello + 24) == targetHash;
+    std::vector<PyramidLevel> pyramid;
+    if (same) pyramid = buildPyramid(target, static_cast<int>(std::min<uint32_t>(genome_get32(hello + 20), 16)));
+
+    uint8_t ready[REMOTE_READY_SIZE];
+    std::memcpy(ready, REMOTE_MAGIC, 4);
+    genome_put32(ready + 4, REMOTE_VERSION);
+    genome_put32(ready + 8, same ? 0 : 1);
+    genome_put32(ready + 12, static_cast<uint32_t>(pyramid.size()));
+    if (!remote_send_all(fd, ready, sizeof(ready)) || !same) {
+        ::close(fd);
+        return;
+    }
+
+    std::vector<uint8_t> payload;
+    std::vector<Individual> genomes;
+    std::vector<double> scores;
+    std::vector<uint8_t> reply;
+    uint8_t header[REMOTE_BATCH_HEADER_SIZE];
+    while (remote_recv_all(fd, header, sizeof(header))) {
+        const uint32_t batch = genome_get32(header);
+        const uint32_t count = genome_get32(header + 4);
+        const uint32_t level = genome_get32(header + 8);
+        const uint32_t bytes = genome_get32(header + 12);
+        if (level >= pyramid.size() || bytes > REMOTE_MAX_PAYLOAD || count > bytes / GENOME_HEADER_SIZE) break;
+        payload.resize(bytes);
+        if (!remote_recv_all(fd, payload.data(), payload.size())) break;
+
+        // Records are self-delimiting; everything after an unreadable one is lost with it
+        genomes.assign(count, Individual());
+        scores.assign(count, -1.0);
+        size_t offset = 0, readable = 0;
+        for (; readable < count; ++readable) {
+            Genome genome;
+            size_t used = decodeGenome(payload.data() + offset, payload.size() - offset, genome);
+            if (used == 0) break;
+            genomes[readable] = std::move(genome.individual);
+            offset += used;
+        }
+        {
+            std::lock_guard<std::mutex> lock(poolMutex); // parallelFor runs one task at a time
+            pool.parallelFor(static_cast<int>(readable), [&](int i) {
+                scores[i] = remoteScore(pyramid[level], target.width, target.height, genomes[i], mode);
+            });
+        }
+
+        reply.resize(8 + 8 * static_cast<size_t>(count));
+        genome_put32(reply.data(), batch);
+        genome_put32(reply.data() + 4, count);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint64_t bits;
+            std::memcpy(&bits, &scores[i], sizeof(bits));
+            remote_put64(reply.data() + 8 + 8 * static_cast<size_t>(i), bits);
+        }
+        if (!remote_send_all(fd, reply.data(), reply.size())) break;
+    }
+    ::close(fd);
+}
+#endif
+
+/**
+ * @brief Worker side: serves evaluation requests for one target on `address`.
+ *
+ * Every coordinator connection gets its own thread. Their batches take turns on
+ * `pool`, so a single batch uses every core of the worker. Runs until the process
+ * is stopped. Returns false with `error` set only if the address cannot be bound.
+ */
+inline bool serveEvaluations(const std::string& address, const Image& target, ThreadPool& pool, std::string& error) {
+#if defined(_WIN32)
+    (void)address;
+    (void)target;
+    (void)pool;
+    error = "Remote evaluation needs POSIX sockets";
+    return false;
+#else
+    int listener = remote_open(address, true, error);
+    if (listener < 0) return false;
+    const Image aligned = alignedImage(target);
+    const uint64_t targetHash = remoteTargetHash(aligned);
+    std::mutex poolMutex;
+    while (true) {
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            // Connection threads hold the target and pool, so keep serving; back off if out of descriptors
+            if (errno != EINTR && errno != ECONNABORTED) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        remote_tune_socket(fd, address.compare(0, 5, "unix:") != 0);
+        std::thread(remote_serve_connection, fd, std::cref(aligned), targetHash, std::ref(pool), std::ref(poolMutex)).detach();
+    }
+#endif
+}
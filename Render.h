@@ -0,0 +1,332 @@
+// Rendering and blending for Pixel32 buffers; no windowing dependency (file output is in ImageWrite.h)
+#pragma once
+#include "Individual.h"
+#include "LoadImage.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <cmath>
+
+enum class BlendMode { AlphaOver, Additive, Overwrite };
+
+static inline uint8_t draw_clamp_u8(int v) { return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v)); }
+
+static inline Pixel32 draw_blend_alpha_over(const Pixel32& dst, const Pixel32& src) {
+    int as = src.a;
+    int inv = 255 - as;
+    Pixel32 out;
+    out.r = draw_clamp_u8((src.r * as + dst.r * inv) / 255);
+    out.g = draw_clamp_u8((src.g * as + dst.g * inv) / 255);
+    out.b = draw_clamp_u8((src.b * as + dst.b * inv) / 255);
+    out.a = draw_clamp_u8(as + (dst.a * inv) / 255);
+    return out;
+}
+
+static inline Pixel32 draw_blend_add(const Pixel32& dst, const Pixel32& src) {
+    Pixel32 out;
+    out.r = draw_clamp_u8(dst.r + src.r);
+    out.g = draw_clamp_u8(dst.g + src.g);
+    out.b = draw_clamp_u8(dst.b + src.b);
+    out.a = draw_clamp_u8(dst.a + src.a);
+    return out;
+}
+
+static inline Pixel32 draw_blend_overwrite(const Pixel32&, const Pixel32& src) { return src; }
+
+typedef Pixel32 (*DrawBlendFn)(const Pixel32&, const Pixel32&);
+
+static inline DrawBlendFn draw_blend_fn(BlendMode mode) {
+    return (mode == BlendMode::AlphaOver) ? &draw_blend_alpha_over
+         : (mode == BlendMode::Additive)  ? &draw_blend_add
+                                          : &draw_blend_overwrite;
+}
+
+// Sum of |a - b| over every RGBA byte of two equally laid out buffers. With canvas layout
+// (aligned rows, zero padding) the count is a multiple of 16 pixels and the padding adds
+// nothing, so whole images are compared flat with aligned loads and no tail loop.
+inline uint64_t pixelAbsDiffSum(const Pixel32* a, const Pixel32* b, size_t count) {
+    uint64_t sum = 0;
+    size_t i = 0;
+#ifdef GENETICART_SSE2
+    if (reinterpret_cast<uintptr_t>(a) % 16 == 0 && reinterpret_cast<uintptr_t>(b) % 16 == 0) {
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 4 <= count; i += 4) {
+            __m128i va = _mm_load_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_load_si128(reinterpret_cast<const __m128i*>(b + i));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb)); // two 64-bit lanes of byte-wise |a - b|
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        sum = lanes[0] + lanes[1];
+    }
+#endif
+    for (; i < count; ++i) {
+        sum += std::abs(a[i].r - b[i].r) + std::abs(a[i].g - b[i].g) + std::abs(a[i].b - b[i].b) + std::abs(a[i].a - b[i].a);
+    }
+    return sum;
+}
+
+// Gene position and length mapped onto a canvas that is `scale` times the full-resolution size
+static inline void draw_scaled_gene(const Gene& g, double scale, Position& pos, int& len) {
+    pos = g.getPosition();
+    len = g.getLength();
+    if (scale != 1.0) {
+        pos.x = static_cast<int>(pos.x * scale);
+        pos.y = static_cast<int>(pos.y * scale);
+        len = static_cast<int>(len * scale);
+    }
+}
+
+// Half-width of a radius-r circle's row at vertical offset dy: |dx| <= span exactly when
+// dx*dx + dy*dy <= r*r; -1 when the row misses the circle
+static inline int draw_circle_span(int dy, int r) {
+    const long long v = static_cast<long long>(r) * r - static_cast<long long>(dy) * dy;
+    if (v < 0) return -1;
+    long long s = static_cast<long long>(std::sqrt(static_cast<double>(v)));
+    while (s * s > v) --s;
+    while ((s + 1) * (s + 1) <= v) ++s;
+    return static_cast<int>(s);
+}
+
+// Calls span(y, xa, xb) for every row of the gene's pixels inside clip, top to bottom.
+// The single description of gene coverage: drawing and the pixel cost model both use it.
+template <typename SpanFn>
+static inline void draw_gene_spans(const Gene& g, double scale, const Rect& clip, SpanFn span) {
+    Position pos;
+    int len;
+    draw_scaled_gene(g, scale, pos, len);
+    if (g.getType() == ShapeType::Circle) {
+        const int r = len;
+        const int x0 = std::max(clip.x0, pos.x - r), x1 = std::min(clip.x1, pos.x + r);
+        const int y0 = std::max(clip.y0, pos.y - r), y1 = std::min(clip.y1, pos.y + r);
+        if (x0 > x1) return;
+        for (int y = y0; y <= y1; ++y) {
+            const int half = draw_circle_span(y - pos.y, r);
+            const int xa = std::max(x0, pos.x - half), xb = std::min(x1, pos.x + half);
+            if (half >= 0 && xa <= xb) span(y, xa, xb);
+        }
+    } else {
+        const int half = len / 2;
+        const int x0 = std::max(clip.x0, pos.x - half), x1 = std::min(clip.x1, pos.x + half);
+        const int y0 = std::max(clip.y0, pos.y - half), y1 = std::min(clip.y1, pos.y + half);
+        if (x0 > x1) return;
+        for (int y = y0; y <= y1; ++y) span(y, x0, x1);
+    }
+}
+
+// Blends one gene into a canvas with `stride` pixels per row, touching only pixels inside clip.
+// Returns the number of pixels blended.
+static inline uint64_t draw_gene(PixelBuffer& out, int stride, const Gene& g, DrawBlendFn doBlend, double scale, const Rect& clip) {
+    const Color col = g.getColor();
+    const Pixel32 src{col.r, col.g, col.b, col.a};
+    uint64_t pixels = 0;
+    draw_gene_spans(g, scale, clip, [&](int y, int xa, int xb) {
+        Pixel32* row = out.data() + static_cast<size_t>(y) * stride;
+        for (int x = xa; x <= xb; ++x) row[x] = doBlend(row[x], src);
+        pixels += static_cast<uint64_t>(xb - xa + 1);
+    });
+    return pixels;
+}
+
+// Pixels one gene covers on a width x height canvas at `scale`, i.e. what drawing it costs,
+// computed row by row without touching a canvas
+inline uint64_t genePixelCost(const Gene& g, int width, int height, double scale = 1.0) {
+    uint64_t pixels = 0;
+    draw_gene_spans(g, scale, Rect{0, 0, width - 1, height - 1}, [&](int, int xa, int xb) { pixels += static_cast<uint64_t>(xb - xa + 1); });
+    return pixels;
+}
+
+// Summed gene coverage: the work one full render of the individual does
+inline uint64_t individualPixelCost(const Individual& individual, int width, int height, double scale = 1.0) {
+    uint64_t pixels = 0;
+    for (const auto& g : individual.dna) pixels += genePixelCost(g, width, height, scale);
+    return pixels;
+}
+
+// The same restricted to `region` of the canvas: the work of re-rendering only that region
+inline uint64_t individualPixelCost(const Individual& individual, const Rect& region, double scale = 1.0) {
+    uint64_t pixels = 0;
+    for (const auto& g : individual.dna) {
+        draw_gene_spans(g, scale, region, [&](int, int xa, int xb) { pixels += static_cast<uint64_t>(xb - xa + 1); });
+    }
+    return pixels;
+}
+
+// What a render did: pixels blended in total and per gene (in DNA order)
+struct RenderStats {
+    uint64_t pixels = 0;
+    uint64_t maxGenePixels = 0;
+    size_t emptyGenes = 0;              // genes that fell entirely outside the canvas
+    std::vector<uint64_t> genePixels;
+};
+
+// scale maps gene coordinates and lengths onto the canvas (e.g. 0.25 for a pyramid level two steps down).
+// Renders into `out`, reusing its capacity (for per-thread scratch canvases). Fills `stats` when given.
+inline void renderIndividualInto(int width, int height, const Individual& individual, BlendMode mode, PixelBuffer& out, double scale = 1.0,
+                                 RenderStats* stats = nullptr) {
+    const int stride = canvasStride(width);
+    out.assign(static_cast<size_t>(stride) * height, Pixel32{0, 0, 0, 0});
+    DrawBlendFn doBlend = draw_blend_fn(mode);
+    const Rect full{0, 0, width - 1, height - 1};
+    if (!stats) {
+        for (const auto& g : individual.dna) {
+            draw_gene(out, stride, g, doBlend, scale, full);
+        }
+        return;
+    }
+    *stats = RenderStats();
+    stats->genePixels.reserve(individual.dna.size());
+    for (const auto& g : individual.dna) {
+        const uint64_t pixels = draw_gene(out, stride, g, doBlend, scale, full);
+        stats->pixels += pixels;
+        stats->maxGenePixels = std::max(stats->maxGenePixels, pixels);
+        if (pixels == 0) ++stats->emptyGenes;
+        stats->genePixels.push_back(pixels);
+    }
+}
+
+inline PixelBuffer renderIndividualToPixels(int width, int height, const Individual& individual, BlendMode mode, double scale = 1.0,
+                                            RenderStats* stats = nullptr) {
+    PixelBuffer out;
+    renderIndividualInto(width, height, individual, mode, out, scale, stats);
+    return out;
+}
+
+// Full-resolution region mapped onto a canvas at `scale`, padded by a pixel for rounding
+inline Rect scaledRegion(const Rect& region, double scale, int width, int height) {
+    if (region.empty()) return Rect::none();
+    if (scale == 1.0) return region.clipped(width, height);
+    return Rect{static_cast<int>(std::floor(region.x0 * scale)) - 1, static_cast<int>(std::floor(region.y0 * scale)) - 1,
+                static_cast<int>(std::floor(region.x1 * scale)) + 1, static_cast<int>(std::floor(region.y1 * scale)) + 1}
+        .clipped(width, height);
+}
+
+// Repaints only `region` (canvas pixels) of an existing full render; every other pixel is left untouched
+inline void renderIndividualRegion(int width, int height, const Individual& individual, BlendMode mode, const Rect& region, PixelBuffer& canvas, double scale = 1.0) {
+    const Rect clip = region.clipped(width, height);
+    if (clip.empty()) return;
+    const int stride = canvasStride(width);
+    for (int y = clip.y0; y <= clip.y1; ++y) {
+        std::fill(canvas.begin() + static_cast<size_t>(y) * stride + clip.x0, canvas.begin() + static_cast<size_t>(y) * stride + clip.x1 + 1, Pixel32{0, 0, 0, 0});
+    }
+    DrawBlendFn doBlend = draw_blend_fn(mode);
+    for (const auto& g : individual.dna) {
+        draw_gene(canvas, stride, g, doBlend, scale, clip);
+    }
+}
+
+// Full-resolution pixels of `region` (already clipped to the image) as a region-sized buffer with
+// region-width rows, e.g. to score a candidate change before committing it to a canvas.
+// Returns the number of pixels blended.
+inline uint64_t renderIndividualPatch(const Individual& individual, BlendMode mode, const Rect& region, PixelBuffer& out) {
+    const int rw = region.x1 - region.x0 + 1, rh = region.y1 - region.y0 + 1;
+    out.assign(static_cast<size_t>(rw) * rh, Pixel32{0, 0, 0, 0});
+    DrawBlendFn doBlend = draw_blend_fn(mode);
+    const Rect patch{0, 0, rw - 1, rh - 1};
+    uint64_t pixels = 0;
+    for (const auto& g : individual.dna) {
+        const Rect b = g.bounds();
+        if (b.x1 < region.x0 || b.x0 > region.x1 || b.y1 < region.y0 || b.y0 > region.y1) continue;
+        const Position pos = g.getPosition();
+        pixels += draw_gene(out, rw, Gene(pos.x - region.x0, pos.y - region.y0, g.getColor(), g.getType(), g.getLength()), doBlend, 1.0, patch);
+    }
+    return pixels;
+}
+
+// Draws the genes that touch `clip` (image coordinates, inside the band) into `out`, a band of
+// canvasStride(width) rows starting at firstRow. Pixels outside clip are left as they are.
+inline void drawIndividualBand(int width, int firstRow, const Individual& individual, BlendMode mode, const Rect& clip, PixelBuffer& out) {
+    DrawBlendFn doBlend = draw_blend_fn(mode);
+    const Rect band{clip.x0, clip.y0 - firstRow, clip.x1, clip.y1 - firstRow};
+    for (const auto& g : individual.dna) {
+        const Rect b = g.bounds();
+        if (b.y1 < clip.y0 || b.y0 > clip.y1 || b.x1 < clip.x0 || b.x0 > clip.x1) continue;
+        const Position pos = g.getPosition();
+        draw_gene(out, canvasStride(width), Gene(pos.x, pos.y - firstRow, g.getColor(), g.getType(), g.getLength()), doBlend, 1.0, band);
+    }
+}
+
+// Rows [firstRow, firstRow + rows) of the full render, for outputs written a band at a time.
+// Genes that miss the band are skipped; the rest are drawn shifted up by firstRow.
+inline void renderIndividualBand(int width, int firstRow, int rows, const Individual& individual, BlendMode mode, PixelBuffer& out) {
+    out.assign(static_cast<size_t>(canvasStride(width)) * rows, Pixel32{0, 0, 0, 0});
+    drawIndividualBand(width, firstRow, individual, mode, Rect{0, firstRow, width - 1, firstRow + rows - 1}, out);
+}
+
+// Canvases composited after every `interval` genes. Immutable once built, so parents, children
+// and elites share them freely; a child only extends its own copy of the pointer list.
+struct RenderCheckpoints {
+    int width;
+    int height;
+    double scale;
+    BlendMode mode;
+    size_t interval;
+    std::vector<std::shared_ptr<const PixelBuffer>> canvases; // canvases[k]: first (k + 1) * interval genes
+};
+
+// Same result as renderIndividualToPixels, but resumes from the last checkpoint before
+// individual.cachedPrefix and records new checkpoints for the genes it repaints.
+inline PixelBuffer renderIndividualCached(int width, int height, Individual& individual, BlendMode mode, size_t interval, double scale = 1.0) {
+    const RenderCheckpoints* old = individual.renderCache.get();
+    size_t reusable = 0;
+    if (old && old->width == width && old->height == height && old->scale == scale && old->mode == mode && old->interval == interval) {
+        reusable = std::min(old->canvases.size(), individual.cachedPrefix / interval);
+    }
+
+    auto cache = std::make_shared<RenderCheckpoints>(RenderCheckpoints{width, height, scale, mode, interval, {}});
+    cache->canvases.reserve(individual.dna.size() / interval);
+    const int stride = canvasStride(width);
+    PixelBuffer out;
+    if (reusable > 0) {
+        cache->canvases.assign(old->canvases.begin(), old->canvases.begin() + reusable);
+        out = *cache->canvases.back();
+    } else {
+        out.assign(static_cast<size_t>(stride) * height, Pixel32{0, 0, 0, 0});
+    }
+
+    DrawBlendFn doBlend = draw_blend_fn(mode);
+    const Rect full{0, 0, width - 1, height - 1};
+    size_t i = reusable * interval;
+    for (auto it = individual.dna.iteratorAt(i); it != individual.dna.end(); ++it, ++i) {
+        draw_gene(out, stride, *it, doBlend, scale, full);
+        if ((i + 1) % interval == 0) {
+            cache->canvases.push_back(std::make_shared<const PixelBuffer>(out));
+        }
+    }
+
+    individual.renderCache = std::move(cache);
+    individual.cachedPrefix = individual.dna.size();
+    return out;
+}
+
+// Composites only the requested pixels, in DNA order. Cost is genes x points rather than
+// the summed gene area, which is what makes sampled fitness estimation cheap.
+inline std::vector<Pixel32> renderIndividualAtPoints(const Individual& individual, BlendMode mode, const std::vector<Position>& points, double scale = 1.0) {
+    std::vector<Pixel32> out(points.size(), Pixel32{0, 0, 0, 0});
+    DrawBlendFn doBlend = draw_blend_fn(mode);
+
+    for (const auto& g : individual.dna) {
+        Position pos;
+        int len;
+        draw_scaled_gene(g, scale, pos, len);
+        const Color col = g.getColor();
+        Pixel32 src{col.r, col.g, col.b, col.a};
+
+        if (g.getType() == ShapeType::Circle) {
+            int rr = len * len;
+            for (size_t i = 0; i < points.size(); ++i) {
+                int dx = points[i].x - pos.x, dy = points[i].y - pos.y;
+                if (dx * dx + dy * dy <= rr) out[i] = doBlend(out[i], src);
+            }
+        } else {
+            int half = len / 2;
+            for (size_t i = 0; i < points.size(); ++i) {
+                if (std::abs(points[i].x - pos.x) <= half && std::abs(points[i].y - pos.y) <= half) out[i] = doBlend(out[i], src);
+            }
+        }
+    }
+    return out;
+}
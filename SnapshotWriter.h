@@ -0,0 +1,94 @@
+// Background rendering and writing of generation snapshots
+#pragma once
+#include "Individual.h"
+#include "Render.h"
+#include "ImageWrite.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <iostream>
+
+/**
+ * @brief Bounded queue feeding one I/O thread.
+ *
+ * The GA hands over a copy of the best genome (cheap: the DNA rope is shared),
+ * and the writer thread renders and encodes it off the critical path.
+ * submit() blocks while `capacity` snapshots are pending, so a slow disk
+ * throttles the GA instead of growing memory without bound.
+ */
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(size_t capacity = 4) : capacity(std::max<size_t>(1, capacity)) {
+        worker = std::thread([this] { run(); });
+    }
+
+    ~SnapshotWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        notEmpty.notify_one();
+        worker.join(); // pending snapshots are still written
+    }
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void submit(const Individual& individual, int width, int height, BlendMode mode, std::string path) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return queue.size() < capacity; });
+        queue.push_back(Job{individual, width, height, mode, std::move(path)});
+        lock.unlock();
+        notEmpty.notify_one();
+    }
+
+    // Blocks until every submitted snapshot is on disk
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return queue.empty() && !writing; });
+    }
+
+private:
+    struct Job {
+        Individual individual;
+        int width;
+        int height;
+        BlendMode mode;
+        std::string path;
+    };
+
+    size_t capacity;
+    std::deque<Job> queue;
+    bool writing = false;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::condition_variable idle;
+    std::thread worker;
+
+    void run() {
+        PixelBuffer canvas; // reused between snapshots
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // stopping and drained
+            Job job = std::move(queue.front());
+            queue.pop_front();
+            writing = true;
+            lock.unlock();
+            notFull.notify_one();
+
+            renderIndividualInto(job.width, job.height, job.individual, job.mode, canvas);
+            if (!savePixels(job.path, job.width, job.height, canvas)) { // encoder chosen by extension
+                std::cerr << "Failed to write snapshot " << job.path << std::endl;
+            }
+
+            lock.lock();
+            writing = false;
+            if (queue.empty()) idle.notify_all();
+        }
+    }
+};
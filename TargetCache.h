@@ -0,0 +1,224 @@
+// Preprocessed target cache: decoded RGBA and every pyramid level in one mappable file
+#pragma once
+#include "LoadImage.h"
+#include "Pyramid.h"
+#include "GenomeIO.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <random>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*
+ * Cache file (little-endian, version 2), named "<source hash>.gatc" after the
+ * FNV-1a 64 hash of the encoded source bytes, so the same picture under any
+ * path hits the same entry and an edited file misses.
+ *
+ *   offset  size  field
+ *   0       4     magic "GATC"
+ *   4       4     version (2)
+ *   8       4     level count
+ *   12      4     reserved (0)
+ *   16      8     source hash
+ *   24      8     source size in bytes
+ *   32      32*n  levels: int32 width, int32 height, int32 stride, reserved, double scale, uint64 pixel offset
+ *   ...           RGBA rows of `stride` pixels per level in canvas layout (see LoadImage.h), every level
+ *                 starting on a 64-byte boundary, so mapped levels are used in place
+ */
+static const char TARGET_CACHE_MAGIC[4] = {'G', 'A', 'T', 'C'};
+static const uint32_t TARGET_CACHE_VERSION = 2;
+static const size_t TARGET_CACHE_HEADER_SIZE = 32;
+static const size_t TARGET_CACHE_LEVEL_SIZE = 32;
+static const size_t TARGET_CACHE_ALIGN = PIXEL_ROW_ALIGN;
+
+static inline uint64_t targetcache_fnv1a(const uint8_t* data, size_t size) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static inline void targetcache_put64(uint8_t* p, uint64_t v) {
+    genome_put32(p, static_cast<uint32_t>(v));
+    genome_put32(p + 4, static_cast<uint32_t>(v >> 32));
+}
+
+static inline uint64_t targetcache_get64(const uint8_t* p) {
+    return genome_get32(p) | (static_cast<uint64_t>(genome_get32(p + 4)) << 32);
+}
+
+static inline size_t targetcache_align(size_t offset) {
+    return (offset + TARGET_CACHE_ALIGN - 1) & ~(TARGET_CACHE_ALIGN - 1);
+}
+
+inline std::string targetCachePath(const std::string& cacheDir, uint64_t sourceHash) {
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.gatc", static_cast<unsigned long long>(sourceHash));
+    return (std::filesystem::path(cacheDir) / name).string();
+}
+
+// "<path>.<pid>.<random>.tmp": private to this writer, in the same directory so the rename is atomic
+static inline std::string targetcache_temp_path(const std::string& path) {
+#if defined(_WIN32)
+    const unsigned long pid = static_cast<unsigned long>(_getpid());
+#else
+    const unsigned long pid = static_cast<unsigned long>(::getpid());
+#endif
+    std::random_device device;
+    char suffix[40];
+    std::snprintf(suffix, sizeof(suffix), ".%lu.%08x.tmp", pid, static_cast<unsigned int>(device()));
+    return path + suffix;
+}
+
+// Whole file, read-only to the caller. Mapped copy-on-write where the platform has mmap,
+// read into memory otherwise; empty pointer if the file cannot be opened.
+static inline std::shared_ptr<uint8_t> targetcache_map(const std::string& path, size_t& size) {
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) return nullptr;
+    const size_t length = size;
+    return std::shared_ptr<uint8_t>(static_cast<uint8_t*>(addr), [length](uint8_t* p) { ::munmap(p, length); });
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return nullptr;
+    size = static_cast<size_t>(in.tellg());
+    const size_t length = size;
+    std::shared_ptr<uint8_t> data(AlignedAllocator<uint8_t>().allocate(length), [length](uint8_t* p) { AlignedAllocator<uint8_t>().deallocate(p, length); });
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(data.get()), static_cast<std::streamsize>(size))) return nullptr;
+    return data;
+#endif
+}
+
+// Levels of a cache file as Images that alias the mapping; empty if the file is missing,
+// malformed, or was made from different source bytes
+inline std::vector<PyramidLevel> readTargetCache(const std::string& path, uint64_t sourceHash, uint64_t sourceSize) {
+    size_t size = 0;
+    std::shared_ptr<uint8_t> file = targetcache_map(path, size);
+    if (!file || size < TARGET_CACHE_HEADER_SIZE) return {};
+    const uint8_t* p = file.get();
+    if (std::memcmp(p, TARGET_CACHE_MAGIC, 4) != 0 || genome_get32(p + 4) != TARGET_CACHE_VERSION
+        || targetcache_get64(p + 16) != sourceHash || targetcache_get64(p + 24) != sourceSize) return {};
+    const size_t count = genome_get32(p + 8);
+    if (count == 0 || (size - TARGET_CACHE_HEADER_SIZE) / TARGET_CACHE_LEVEL_SIZE < count) return {};
+
+    std::vector<PyramidLevel> pyramid;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* entry = p + TARGET_CACHE_HEADER_SIZE + i * TARGET_CACHE_LEVEL_SIZE;
+        PyramidLevel level;
+        level.width = static_cast<int>(genome_get32(entry));
+        level.height = static_cast<int>(genome_get32(entry + 4));
+        level.stride = static_cast<int>(genome_get32(entry + 8));
+        uint64_t bits = targetcache_get64(entry + 16);
+        std::memcpy(&level.scale, &bits, sizeof(bits));
+        const uint64_t offset = targetcache_get64(entry + 24);
+        if (level.width <= 0 || level.height <= 0 || level.stride != canvasStride(level.width) || offset % TARGET_CACHE_ALIGN != 0
+            || offset > size || (size - offset) / 4 / level.stride < static_cast<size_t>(level.height)) return {};
+        level.buffer = std::shared_ptr<Pixel32>(file, reinterpret_cast<Pixel32*>(file.get() + offset));
+        pyramid.push_back(std::move(level));
+    }
+    return pyramid;
+}
+
+// Written to a temporary file of its own and renamed, so concurrent jobs building the same
+// entry never share a file and a reader never maps a half-written cache
+inline bool writeTargetCache(const std::string& path, const std::vector<PyramidLevel>& pyramid, uint64_t sourceHash, uint64_t sourceSize) {
+    std::vector<uint8_t> header(TARGET_CACHE_HEADER_SIZE + TARGET_CACHE_LEVEL_SIZE * pyramid.size());
+    uint8_t* p = header.data();
+    std::memcpy(p, TARGET_CACHE_MAGIC, 4);
+    genome_put32(p + 4, TARGET_CACHE_VERSION);
+    genome_put32(p + 8, static_cast<uint32_t>(pyramid.size()));
+    targetcache_put64(p + 16, sourceHash);
+    targetcache_put64(p + 24, sourceSize);
+    size_t offset = targetcache_align(header.size());
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < pyramid.size(); ++i) {
+        uint8_t* entry = p + TARGET_CACHE_HEADER_SIZE + i * TARGET_CACHE_LEVEL_SIZE;
+        genome_put32(entry, static_cast<uint32_t>(pyramid[i].width));
+        genome_put32(entry + 4, static_cast<uint32_t>(pyramid[i].height));
+        genome_put32(entry + 8, static_cast<uint32_t>(pyramid[i].stride));
+        uint64_t bits;
+        std::memcpy(&bits, &pyramid[i].scale, sizeof(bits));
+        targetcache_put64(entry + 16, bits);
+        targetcache_put64(entry + 24, offset);
+        offsets.push_back(offset);
+        offset = targetcache_align(offset + static_cast<size_t>(pyramid[i].stride) * pyramid[i].height * 4);
+    }
+
+    const std::string tmp = targetcache_temp_path(path);
+    std::error_code ec;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        size_t written = header.size();
+        const char zeros[TARGET_CACHE_ALIGN] = {};
+        for (size_t i = 0; i < pyramid.size(); ++i) {
+            out.write(zeros, static_cast<std::streamsize>(offsets[i] - written));
+            const size_t bytes = static_cast<size_t>(pyramid[i].stride) * pyramid[i].height * 4;
+            out.write(reinterpret_cast<const char*>(pyramid[i].data()), static_cast<std::streamsize>(bytes));
+            written = offsets[i] + bytes;
+        }
+        out.flush();
+        if (!out) {
+            out.close();
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) std::filesystem::remove(tmp, ec);
+    return !ec;
+}
+
+/**
+ * @brief Loads an image file and its full pyramid through a cache directory.
+ *
+ * On a hit the levels are mapped straight from "<cacheDir>/<hash>.gatc" with no
+ * decode or downsampling; on a miss the file is decoded, every level down to
+ * 2x2 is built, and the cache is written for the next run. Callers take as many
+ * levels as they need. Cache write failures only cost the next run its speedup.
+ */
+inline std::vector<PyramidLevel> loadTargetPyramid(const std::string& path, const std::string& cacheDir) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to load image");
+    }
+    std::vector<uint8_t> source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const uint64_t hash = targetcache_fnv1a(source.data(), source.size());
+    const std::string cachePath = targetCachePath(cacheDir, hash);
+
+    std::vector<PyramidLevel> pyramid = readTargetCache(cachePath, hash, source.size());
+    if (!pyramid.empty()) return pyramid;
+
+    pyramid = buildPyramid(loadImageFromMemory(source.data(), source.size()), 64);
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir, ec);
+    writeTargetCache(cachePath, pyramid, hash, source.size());
+    return pyramid;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Fixed set of worker threads reused across generations and jobs.
+ *
+ * parallelFor() hands an index range to the workers and blocks until every
+ * index has been processed; the calling thread works too. Thread-local
+ * scratch buffers in the render and fitness code therefore survive from one
+ * GeneticAlgorithm run to the next instead of being reallocated per call.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threads = std::thread::hardware_concurrency()) {
+        threads = std::max(1u, threads);
+        for (unsigned int i = 1; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+    // Calls fn(i) for every i in [0, count) and returns when all calls have finished
+    void parallelFor(int count, const std::function<void(int)>& fn) {
+        if (count <= 0) return;
+        std::unique_lock<std::mutex> lock(mutex);
+        task = &fn;
+        taskCount = count;
+        nextIndex = 0;
+        busy = static_cast<int>(workers.size());
+        ++epoch;
+        lock.unlock();
+        wake.notify_all();
+
+        runTask(fn, count);
+
+        lock.lock();
+        done.wait(lock, [this] { return busy == 0; });
+        task = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)>* task = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextIndex{0};
+    int busy = 0;
+    unsigned long long epoch = 0;
+    bool stopping = false;
+
+    void runTask(const std::function<void(int)>& fn, int count) {
+        while (true) {
+            int idx = nextIndex.fetch_add(1);
+            if (idx >= count) break;
+            fn(idx);
+        }
+    }
+
+    void workerLoop() {
+        unsigned long long seen = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || epoch != seen; });
+            if (stopping) return;
+            seen = epoch;
+            const std::function<void(int)>* fn = task;
+            int count = taskCount;
+            lock.unlock();
+
+            runTask(*fn, count);
+
+            lock.lock();
+            if (--busy == 0) done.notify_one();
+        }
+    }
+};
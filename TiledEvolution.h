@@ -0,0 +1,248 @@
+// Tiled evolution for targets too large to evolve (or hold) as one image
+#pragma once
+#include "LoadImage.h"
+#include "Individual.h"
+#include "Render.h"
+#include "GenomeIO.h"
+#include "ImageWrite.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief Read access to rectangles of a target without requiring all of it in memory.
+ */
+class TileSource {
+public:
+    virtual ~TileSource() = default;
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+    // Copies the pixels of `region` (inclusive, inside the image) into rows of `stride` pixels at out
+    virtual bool read(const Rect& region, Pixel32* out, int stride) = 0;
+};
+
+// Any Image, including levels mapped from the target cache: only the touched pages are resident
+class ImageTileSource : public TileSource {
+public:
+    explicit ImageTileSource(Image image) : image(std::move(image)) {}
+    int width() const override { return image.width; }
+    int height() const override { return image.height; }
+    bool read(const Rect& region, Pixel32* out, int stride) override {
+        const int rowPixels = region.x1 - region.x0 + 1;
+        for (int y = region.y0; y <= region.y1; ++y, out += stride) {
+            const Pixel32* row = image.row(y) + region.x0;
+            std::copy(row, row + rowPixels, out);
+        }
+        return true;
+    }
+
+private:
+    Image image;
+};
+
+// Binary PPM (P6) or PAM (P7, RGB or RGB_ALPHA) read straight from disk, one row span at a time
+class PnmTileSource : public TileSource {
+public:
+    explicit PnmTileSource(const std::string& path) : in(path, std::ios::binary) {
+        if (!in || !parseHeader()) {
+            throw std::runtime_error("Failed to load image");
+        }
+    }
+    int width() const override { return w; }
+    int height() const override { return h; }
+    bool read(const Rect& region, Pixel32* out, int stride) override {
+        const size_t rowPixels = static_cast<size_t>(region.x1 - region.x0 + 1);
+        row.resize(rowPixels * depth);
+        for (int y = region.y0; y <= region.y1; ++y, out += stride) {
+            in.seekg(static_cast<std::streamoff>(dataOffset + (static_cast<size_t>(y) * w + region.x0) * depth));
+            if (!in.read(reinterpret_cast<char*>(row.data()), static_cast<std::streamsize>(row.size()))) return false;
+            for (size_t x = 0; x < rowPixels; ++x) {
+                const uint8_t* p = row.data() + x * depth;
+                out[x] = Pixel32{p[0], p[1], p[2], depth == 4 ? p[3] : static_cast<uint8_t>(255)};
+            }
+        }
+        return true;
+    }
+
+private:
+    std::ifstream in;
+    int w = 0;
+    int h = 0;
+    int depth = 0;
+    size_t dataOffset = 0;
+    std::vector<uint8_t> row;
+
+    bool parseHeader() {
+        std::string magic;
+        in >> magic;
+        int maxval = 0;
+        if (magic == "P6") {
+            depth = 3;
+            in >> w >> h >> maxval;
+            in.get(); // single whitespace before the raster
+        } else if (magic == "P7") {
+            std::string line;
+            std::getline(in, line);
+            while (std::getline(in, line) && line != "ENDHDR") {
+                std::istringstream fields(line);
+                std::string key;
+                fields >> key;
+                if (key == "WIDTH") fields >> w;
+                else if (key == "HEIGHT") fields >> h;
+                else if (key == "DEPTH") fields >> depth;
+                else if (key == "MAXVAL") fields >> maxval;
+            }
+        } else {
+            return false;
+        }
+        if (!in || w <= 0 || h <= 0 || maxval != 255 || (depth != 3 && depth != 4)) return false;
+        dataOffset = static_cast<size_t>(in.tellg());
+        return true;
+    }
+};
+
+// PPM/PAM files stream from disk; anything else is decoded once (or mapped through the target cache)
+inline std::unique_ptr<TileSource> openTileSource(const std::string& path, const std::function<Image(const std::string&)>& loadWhole) {
+    auto endsWith = [&](const char* ext) {
+        size_t n = std::strlen(ext);
+        return path.size() >= n && path.compare(path.size() - n, n, ext) == 0;
+    };
+    if (endsWith(".ppm") || endsWith(".pam")) return std::make_unique<PnmTileSource>(path);
+    return std::make_unique<ImageTileSource>(loadWhole(path));
+}
+
+struct Tile {
+    Rect core;   // pixels this tile owns in the stitched result
+    Rect region; // core plus overlap on every side, clipped to the image: what the tile evolves against
+};
+
+// Cores partition the image on a tileSize grid; regions extend each core by `overlap`
+inline std::vector<Tile> tileLayout(int width, int height, int tileSize, int overlap) {
+    std::vector<Tile> tiles;
+    for (int y = 0; y < height; y += tileSize) {
+        for (int x = 0; x < width; x += tileSize) {
+            Rect core{x, y, std::min(width, x + tileSize) - 1, std::min(height, y + tileSize) - 1};
+            Rect region = Rect{core.x0 - overlap, core.y0 - overlap, core.x1 + overlap, core.y1 + overlap}.clipped(width, height);
+            tiles.push_back(Tile{core, region});
+        }
+    }
+    return tiles;
+}
+
+struct TiledOptions {
+    int tileSize = 256;
+    int overlap = 32;
+    BlendMode mode = BlendMode::AlphaOver;
+    std::string tileDir; // finished tiles: tile_<x>_<y>.gad plus tile_<x>_<y>.run, the parameters that made it
+    bool resume = false; // reuse finished tiles, but only those whose .run text equals runKey
+    std::string runKey;  // every run parameter that decides a tile's result, as text
+};
+
+// A finished tile: every gene it evolved, shifted to image coordinates, and the core it owns
+struct TilePiece {
+    Rect core;
+    Individual individual;
+};
+
+/**
+ * @brief Evolves a large target tile by tile.
+ *
+ * Only one tile's pixels and one GA are alive at a time, so memory is bounded by
+ * the tile size plus the finished genes. Each tile sees its overlap margin, so
+ * genes near a seam are fitted with the neighbouring pixels in view. Finished
+ * tiles are saved to <tileDir>/tile_<x>_<y>.gad with the run parameters beside
+ * them. With options.resume an interrupted mural continues at the first tile not
+ * finished under the same parameters; otherwise every tile is evolved afresh.
+ *
+ * evolveTile receives the tile's target (dimensions of Tile::region) and its index.
+ */
+inline std::vector<TilePiece> evolveTiled(TileSource& source, const TiledOptions& options,
+                                          const std::function<Individual(const Image& tile, size_t index)>& evolveTile) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::create_directories(options.tileDir, ec);
+    const BlendMode mode = options.mode;
+
+    const std::vector<Tile> tiles = tileLayout(source.width(), source.height(), options.tileSize, options.overlap);
+    std::vector<TilePiece> pieces;
+    Image tile;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        const Rect& region = tiles[i].region;
+        const int w = region.x1 - region.x0 + 1, h = region.y1 - region.y0 + 1;
+        const std::string base = (fs::path(options.tileDir) / ("tile_" + std::to_string(tiles[i].core.x0) + "_" + std::to_string(tiles[i].core.y0))).string();
+        const std::string genomePath = base + ".gad", runPath = base + ".run";
+
+        Individual best;
+        std::vector<Genome> saved;
+        if (options.resume) {
+            std::ifstream in(runPath, std::ios::binary);
+            std::stringstream recorded;
+            recorded << in.rdbuf();
+            if (in && recorded.str() == options.runKey) saved = loadGenomes(genomePath);
+        }
+        if (!saved.empty() && saved[0].width == w && saved[0].height == h && saved[0].mode == mode) {
+            best = saved[0].individual;
+        } else {
+            if (tile.width != w || tile.height != h || tile.buffer.use_count() > 1) tile = allocateImage(w, h);
+            if (!source.read(region, tile.mutableData(), tile.stride)) {
+                throw std::runtime_error("Failed to read tile " + std::to_string(i));
+            }
+            best = evolveTile(tile, i);
+            // Parameters last, so a tile interrupted between the two files is evolved again
+            fs::remove(runPath, ec);
+            if (saveGenome(genomePath, best, w, h, mode)) {
+                std::ofstream(runPath, std::ios::binary | std::ios::trunc) << options.runKey;
+            }
+        }
+
+        TilePiece piece{tiles[i].core, Individual()};
+        for (const auto& g : best.dna) {
+            const Position pos = g.getPosition();
+            piece.individual.dna.push_back(Gene(pos.x + region.x0, pos.y + region.y0, g.getColor(), g.getType(), g.getLength()));
+        }
+        pieces.push_back(std::move(piece));
+    }
+    return pieces;
+}
+
+// One genome for the whole image (for .gad and .svg output): each tile's genes whose centre lies in
+// its core. Genes near a seam still reach into the neighbouring core, so this is close to, but not
+// the same as, the clipped render saveTilesStreamed writes.
+inline Individual stitchTiles(const std::vector<TilePiece>& pieces) {
+    Individual stitched;
+    for (const auto& piece : pieces) {
+        const Rect& core = piece.core;
+        for (const auto& g : piece.individual.dna) {
+            const Position pos = g.getPosition();
+            if (pos.x < core.x0 || pos.x > core.x1 || pos.y < core.y0 || pos.y > core.y1) continue;
+            stitched.dna.push_back(g);
+        }
+    }
+    return stitched;
+}
+
+// Renders the tiles band by band straight into a TGA/PPM/PAM file. Every tile draws all of its genes
+// clipped to its core, so each pixel shows exactly the render its tile was evolved to match and
+// genes never spill across a seam.
+inline bool saveTilesStreamed(const std::string& path, int width, int height, const std::vector<TilePiece>& pieces, BlendMode mode, int bandRows = 256) {
+    PixelStreamWriter writer;
+    if (!writer.open(path, width, height)) return false;
+    PixelBuffer band;
+    for (int y = 0; y < height; y += bandRows) {
+        const int rows = std::min(bandRows, height - y);
+        band.assign(static_cast<size_t>(canvasStride(width)) * rows, Pixel32{0, 0, 0, 0});
+        for (const auto& piece : pieces) {
+            const Rect clip{piece.core.x0, std::max(piece.core.y0, y), piece.core.x1, std::min(piece.core.y1, y + rows - 1)};
+            if (clip.y0 > clip.y1) continue;
+            drawIndividualBand(width, y, piece.individual, mode, clip, band);
+        }
+        if (!writer.writeRows(band.data(), rows, canvasStride(width))) return false;
+    }
+    return writer.close();
+}
@@ -0,0 +1,101 @@
+// Fixtures shared by the benchmark programs: procedural targets, synthetic genomes, GA access
+#pragma once
+#include "GeneticAlgorithm.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+// Smooth gradients plus a few hard-edged discs: cheap to make, deterministic, and not trivially fit
+inline Image proceduralTarget(int width, int height, unsigned int seed = 1) {
+    Image img = allocateImage(width, height);
+    Random rand(seed);
+    struct Disc { int x, y, r; Pixel32 c; };
+    std::vector<Disc> discs;
+    for (int i = 0; i < 12; ++i) {
+        discs.push_back(Disc{rand.getInt(0, width - 1), rand.getInt(0, height - 1), rand.getInt(2, std::max(3, std::min(width, height) / 4)),
+                             Pixel32{static_cast<uint8_t>(rand.getInt(0, 255)), static_cast<uint8_t>(rand.getInt(0, 255)), static_cast<uint8_t>(rand.getInt(0, 255)), 255}});
+    }
+    for (int y = 0; y < height; ++y) {
+        Pixel32* row = img.mutableData() + static_cast<size_t>(y) * img.stride;
+        for (int x = 0; x < width; ++x) {
+            Pixel32 p{static_cast<uint8_t>(255 * x / std::max(1, width - 1)), static_cast<uint8_t>(255 * y / std::max(1, height - 1)),
+                      static_cast<uint8_t>(128 + 127 * std::sin((x + y) * 0.05)), 255};
+            for (const auto& d : discs) {
+                if ((x - d.x) * (x - d.x) + (y - d.y) * (y - d.y) <= d.r * d.r) p = d.c;
+            }
+            row[x] = p;
+        }
+    }
+    return img;
+}
+
+// `genes` genes of one shape with lengths fixed at `length`, uniformly placed, half-transparent colours
+inline Individual syntheticIndividual(Random& rand, int width, int height, int genes, int length, ShapeType shape) {
+    Individual individual;
+    for (int i = 0; i < genes; ++i) {
+        Color c{static_cast<uint8_t>(rand.getInt(0, 255)), static_cast<uint8_t>(rand.getInt(0, 255)), static_cast<uint8_t>(rand.getInt(0, 255)),
+                static_cast<uint8_t>(rand.getInt(32, 224))};
+        individual.dna.push_back(Gene(rand.getInt(0, width - 1), rand.getInt(0, height - 1), c, shape, length));
+    }
+    return individual;
+}
+
+// Discards std::cout while alive (the GA reports progress on every evaluation)
+struct BenchQuietCout {
+    std::ostringstream sink;
+    std::streambuf* saved;
+    BenchQuietCout() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~BenchQuietCout() { std::cout.rdbuf(saved); }
+};
+
+// Starts a new peak-RSS window where the kernel allows it (Linux clear_refs); elsewhere the
+// peak stays the process-wide high-water mark
+inline void benchResetPeakRss() {
+#if defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+// Peak resident set size in bytes since the last reset (0 where unavailable)
+inline uint64_t benchPeakRssBytes() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::stoull(line.substr(6)) * 1024;
+    }
+#endif
+#if !defined(_WIN32)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief Reaches the GA phases that are private to GeneticAlgorithm.
+ *
+ * Build the GA with generations = 0: the constructor then only initializes and
+ * scores the population, which leaves a realistic state to time phases against.
+ */
+struct GeneticAlgorithmBenchAccess {
+    static void evaluate(GeneticAlgorithm& ga, Individual& individual) { ga.evaluateFitnessIndividual(individual); }
+    static void refreshSamples(GeneticAlgorithm& ga) { ga.refreshFitnessSamples(); }
+    static Individual tournament(GeneticAlgorithm& ga, int size) { return ga.tournamentSelection(size); }
+    static Individual crossover(GeneticAlgorithm& ga, const Individual& a, const Individual& b) { return ga.crossover(a, b, ga.rand); }
+    static bool mutate(GeneticAlgorithm& ga, Individual& individual) { return ga.maybeMutate(individual, ga.rand); }
+    static std::vector<Individual>& population(GeneticAlgorithm& ga) { return ga.population; }
+};
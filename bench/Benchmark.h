@@ -0,0 +1,161 @@
+// Minimal self-contained benchmark harness with JSON output
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <ctime>
+
+// Keeps the optimizer from discarding a value whose computation is being timed
+template <typename T>
+inline void benchKeep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchParam {
+    std::string name;
+    double value;
+};
+
+struct BenchResult {
+    std::string name;
+    std::vector<BenchParam> params;
+    int64_t iterations = 0;    // per repetition
+    double nsPerOp = 0.0;      // median over repetitions
+    double nsPerOpMin = 0.0;
+    double nsPerOpMax = 0.0;
+    std::vector<std::pair<std::string, double>> counters; // extras recorded by the case, e.g. estimate error
+};
+
+/**
+ * @brief Registers and runs timed cases.
+ *
+ * Each case is a setup function that builds its fixtures untimed (and may
+ * record extra per-case counters) and returns the body, which performs
+ * `iterations` operations. The runner grows the
+ * iteration count until one batch takes at least minTime, then times
+ * `repetitions` batches of that size and reports the median ns/op.
+ */
+class BenchRunner {
+public:
+    using Body = std::function<void(int64_t iterations)>;
+    using Counters = std::vector<std::pair<std::string, double>>;
+    using Setup = std::function<Body(Counters& counters)>;
+
+    double minTime = 0.1; // seconds per repetition
+    int repetitions = 3;
+    std::string filter;   // run only cases whose full name contains this
+
+    void add(std::string name, std::vector<BenchParam> params, Setup setup) {
+        cases.push_back(Case{std::move(name), std::move(params), std::move(setup)});
+    }
+
+    // Runs every case matching the filter; a one-line summary per case goes to `log`
+    std::vector<BenchResult> run(std::ostream& log) {
+        std::vector<BenchResult> results;
+        for (auto& c : cases) {
+            const std::string full = fullName(c.name, c.params);
+            if (!filter.empty() && full.find(filter) == std::string::npos) continue;
+
+            Counters counters;
+            const Body body = c.setup(counters);
+            int64_t iterations = 1;
+            while (true) {
+                double seconds = time(body, iterations);
+                if (seconds >= minTime || iterations >= (int64_t(1) << 40)) break;
+                double grow = seconds > 0.0 ? minTime * 1.4 / seconds : 10.0;
+                iterations = std::max(iterations + 1, static_cast<int64_t>(iterations * std::min(10.0, grow)));
+            }
+            std::vector<double> samples;
+            for (int r = 0; r < std::max(1, repetitions); ++r) {
+                samples.push_back(time(body, iterations) * 1e9 / static_cast<double>(iterations));
+            }
+            std::sort(samples.begin(), samples.end());
+
+            BenchResult result;
+            result.name = c.name;
+            result.params = c.params;
+            result.iterations = iterations;
+            result.nsPerOp = samples[samples.size() / 2];
+            result.nsPerOpMin = samples.front();
+            result.nsPerOpMax = samples.back();
+            result.counters = std::move(counters);
+            log << full << ": " << result.nsPerOp << " ns/op (" << iterations << " iterations)" << std::endl;
+            results.push_back(std::move(result));
+        }
+        return results;
+    }
+
+    static std::string fullName(const std::string& name, const std::vector<BenchParam>& params) {
+        std::ostringstream out;
+        out << name;
+        for (const auto& p : params) out << "/" << p.name << ":" << p.value;
+        return out.str();
+    }
+
+private:
+    struct Case {
+        std::string name;
+        std::vector<BenchParam> params;
+        Setup setup;
+    };
+    std::vector<Case> cases;
+
+    static double time(const Body& body, int64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+static inline std::string bench_json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+// "context": {"suite", "date", "hardware_concurrency"}, shared by every benchmark program's output
+inline void writeBenchContext(std::ostream& out, const std::string& suite) {
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    out << "\"context\": {\"suite\": \"" << bench_json_escape(suite) << "\", \"date\": \"" << date
+        << "\", \"hardware_concurrency\": " << std::thread::hardware_concurrency() << "}";
+}
+
+// {"context": {...}, "benchmarks": [{"name", "params", "iterations", "ns_per_op", ...}]}
+inline void writeBenchJson(std::ostream& out, const std::string& suite, const std::vector<BenchResult>& results) {
+    out << "{\n  ";
+    writeBenchContext(out, suite);
+    out << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << bench_json_escape(BenchRunner::fullName(r.name, r.params))
+            << "\", \"group\": \"" << bench_json_escape(r.name) << "\", \"params\": {";
+        for (size_t p = 0; p < r.params.size(); ++p) {
+            out << (p ? ", " : "") << "\"" << bench_json_escape(r.params[p].name) << "\": " << r.params[p].value;
+        }
+        out << "}, \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.nsPerOp
+            << ", \"ns_per_op_min\": " << r.nsPerOpMin << ", \"ns_per_op_max\": " << r.nsPerOpMax;
+        for (const auto& counter : r.counters) {
+            out << ", \"" << bench_json_escape(counter.first) << "\": " << counter.second;
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
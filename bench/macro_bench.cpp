@@ -0,0 +1,222 @@
+// End-to-end throughput and time-to-quality: whole GA runs with fixed seeds on reference images.
+// Usage: genetic_art_macro_bench [--filter TEXT] [--generations N] [--population N] [--seeds 1,2,...]
+//                                [--thresholds 0.5,0.4,...] [--image PATH]... [--threads N] [--quick] [--json FILE]
+#define STB_IMAGE_IMPLEMENTATION // this program decodes the reference pictures itself
+#include "Benchmark.h"
+#include "BenchSupport.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+// Bundled reference picture, found through the source tree the benchmark was built from
+#ifndef GENETICART_BENCH_DATA_DIR
+#define GENETICART_BENCH_DATA_DIR "."
+#endif
+
+struct MacroImage {
+    std::string name;
+    Image target; // canvas layout
+};
+
+struct MacroMode {
+    const char* name;
+    GeneticAlgorithmOptions options;
+};
+
+struct MacroThreshold {
+    double fraction;       // of the blank-canvas error
+    int generation = -1;   // first generation at or below it; -1 = not reached
+    double seconds = 0.0;  // GA time (excluding the benchmark's own scoring) when it was reached
+};
+
+struct MacroRun {
+    std::string image, mode;
+    unsigned int seed = 0;
+    int width = 0, height = 0, population = 0, generations = 0;
+    double seconds = 0.0;
+    int64_t evaluations = 0;
+    uint64_t peakRss = 0;
+    double blankError = 0.0, initialError = 0.0, finalError = 0.0; // mean absolute error per channel
+    size_t finalGenes = 0;
+    uint64_t finalPixels = 0; // pixels a render of the final best individual blends
+    std::vector<MacroThreshold> thresholds;
+};
+
+// Full-resolution mean absolute error per channel, whatever the run scored on internally
+static double meanChannelError(const Image& target, const Individual& individual, BlendMode mode) {
+    PixelBuffer canvas = renderIndividualToPixels(target.width, target.height, individual, mode);
+    return static_cast<double>(pixelAbsDiffSum(target.data(), canvas.data(), canvas.size())) / (4.0 * target.size());
+}
+
+static MacroRun runOnce(const MacroImage& image, const MacroMode& mode, unsigned int seed, int population, int generations,
+                        const std::vector<double>& fractions, ThreadPool& pool) {
+    using Clock = std::chrono::steady_clock;
+    MacroRun run;
+    run.image = image.name;
+    run.mode = mode.name;
+    run.seed = seed;
+    run.width = image.target.width;
+    run.height = image.target.height;
+    run.population = population;
+    run.generations = generations;
+    run.blankError = meanChannelError(image.target, Individual(), BlendMode::AlphaOver);
+    for (double f : fractions) run.thresholds.push_back(MacroThreshold{f});
+
+    GeneticAlgorithmOptions options = mode.options;
+    options.seed = seed;
+    options.snapshotEvery = 0;
+    options.pool = &pool;
+
+    // Scoring the best individual at full resolution is benchmark overhead, kept off the clock
+    Clock::time_point start;
+    Clock::duration excluded{};
+    options.onGeneration = [&](int generation, const Individual& best) {
+        Clock::time_point now = Clock::now();
+        double error = meanChannelError(image.target, best, BlendMode::AlphaOver);
+        if (generation == 1) run.initialError = error;
+        run.finalError = error;
+        run.finalGenes = best.dna.size();
+        run.finalPixels = individualPixelCost(best, image.target.width, image.target.height);
+        const double seconds = std::chrono::duration<double>(now - start - excluded).count();
+        for (auto& t : run.thresholds) {
+            if (t.generation < 0 && error <= t.fraction * run.blankError) {
+                t.generation = generation;
+                t.seconds = seconds;
+            }
+        }
+        excluded += Clock::now() - now;
+    };
+
+    benchResetPeakRss();
+    {
+        BenchQuietCout quiet;
+        start = Clock::now();
+        GeneticAlgorithm ga(population, 3, 1, image.target.width, image.target.height, image.target, 10, 32, generations, ShapeType::Circle,
+                            BlendMode::AlphaOver, options);
+        run.seconds = std::chrono::duration<double>(Clock::now() - start - excluded).count();
+    }
+    run.peakRss = benchPeakRssBytes();
+    // The initial population plus one per generation; sampled runs also re-score finalists exactly
+    run.evaluations = static_cast<int64_t>(population) * (generations + 1);
+    return run;
+}
+
+static std::vector<double> parseList(const std::string& text) {
+    std::vector<double> values;
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) values.push_back(std::stod(item));
+    }
+    return values;
+}
+
+static void writeMacroJson(std::ostream& out, const std::vector<MacroRun>& runs) {
+    out << "{\n  ";
+    writeBenchContext(out, "macro");
+    out << ",\n  \"runs\": [";
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const MacroRun& r = runs[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << bench_json_escape(r.image + "/" + r.mode + "/seed:" + std::to_string(r.seed))
+            << "\", \"image\": \"" << bench_json_escape(r.image) << "\", \"mode\": \"" << r.mode << "\", \"seed\": " << r.seed
+            << ", \"width\": " << r.width << ", \"height\": " << r.height << ", \"population\": " << r.population
+            << ", \"generations\": " << r.generations << ", \"seconds\": " << r.seconds
+            << ", \"generations_per_second\": " << r.generations / r.seconds << ", \"evaluations\": " << r.evaluations
+            << ", \"evaluations_per_second\": " << r.evaluations / r.seconds << ", \"peak_rss_bytes\": " << r.peakRss
+            << ", \"blank_error\": " << r.blankError << ", \"initial_error\": " << r.initialError << ", \"final_error\": " << r.finalError
+            << ", \"final_genes\": " << r.finalGenes << ", \"final_pixels\": " << r.finalPixels << ", \"thresholds\": [";
+        for (size_t t = 0; t < r.thresholds.size(); ++t) {
+            const MacroThreshold& th = r.thresholds[t];
+            out << (t ? ", " : "") << "{\"fraction\": " << th.fraction << ", \"error\": " << th.fraction * r.blankError;
+            if (th.generation >= 0) out << ", \"generation\": " << th.generation << ", \"seconds\": " << th.seconds << "}";
+            else out << ", \"generation\": null, \"seconds\": null}";
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    std::string filter, jsonPath;
+    int generations = 200, population = 50;
+    unsigned int threads = std::thread::hardware_concurrency();
+    bool quick = false;
+    std::vector<double> seeds = {1, 2, 3};
+    std::vector<double> fractions = {0.6, 0.5, 0.4, 0.35, 0.3};
+    std::vector<std::string> imagePaths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string { return i + 1 < argc ? argv[++i] : std::string(); };
+        if (arg == "--filter") filter = value();
+        else if (arg == "--generations") generations = std::stoi(value());
+        else if (arg == "--population") population = std::stoi(value());
+        else if (arg == "--seeds") seeds = parseList(value());
+        else if (arg == "--thresholds") fractions = parseList(value());
+        else if (arg == "--image") imagePaths.push_back(value());
+        else if (arg == "--threads") threads = static_cast<unsigned int>(std::stoi(value()));
+        else if (arg == "--quick") quick = true;
+        else if (arg == "--json") jsonPath = value();
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter TEXT] [--generations N] [--population N] [--seeds 1,2,...]"
+                      << " [--thresholds 0.5,0.4,...] [--image PATH]... [--threads N] [--quick] [--json FILE]" << std::endl;
+            return 2;
+        }
+    }
+    if (quick) {
+        generations = std::min(generations, 50);
+        seeds.resize(1);
+    }
+
+    std::vector<MacroImage> images = {{"procedural-128", proceduralTarget(128, 128)}, {"procedural-256", proceduralTarget(256, 256)}};
+    if (imagePaths.empty()) {
+        const std::string bundled = std::string(GENETICART_BENCH_DATA_DIR) + "/pic.jpg";
+        if (std::filesystem::exists(bundled)) imagePaths.push_back(bundled);
+    }
+    for (const auto& path : imagePaths) {
+        try {
+            images.push_back({std::filesystem::path(path).filename().string(), alignedImage(loadImage(path))});
+        } catch (const std::exception& e) {
+            std::cerr << path << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<MacroMode> modes = {{"exact", {}}, {"sampled", {}}, {"error-tables", {}}, {"pyramid", {}}, {"steady-state", {}}, {"hill-climb", {}},
+                                  {"hill-climb-adaptive", {}}};
+    modes[1].options.fitnessSamples = 1024;
+    modes[1].options.exactFinalists = 4;
+    modes[2].options.errorTables = true;
+    modes[3].options.pyramidLevels = 2;
+    modes[4].options.steadyState = true;
+    modes[5].options.hillClimb = true;
+    modes[6].options.hillClimb = true;
+    modes[6].options.adaptiveOperators = true;
+
+    ThreadPool pool(threads);
+    std::vector<MacroRun> runs;
+    for (const auto& image : images) {
+        for (const auto& mode : modes) {
+            for (double seed : seeds) {
+                const std::string name = image.name + "/" + mode.name + "/seed:" + std::to_string(static_cast<unsigned int>(seed));
+                if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+                MacroRun run = runOnce(image, mode, static_cast<unsigned int>(seed), population, generations, fractions, pool);
+                std::cerr << name << ": " << run.generations / run.seconds << " gen/s, " << run.evaluations / run.seconds << " evals/s, error "
+                          << run.initialError << " -> " << run.finalError << ", peak RSS " << run.peakRss / (1024 * 1024) << " MiB" << std::endl;
+                runs.push_back(std::move(run));
+            }
+        }
+    }
+
+    // Progress on stderr; JSON to the file, or to stdout when no file is given
+    if (jsonPath.empty()) {
+        writeMacroJson(std::cout, runs);
+    } else {
+        std::ofstream out(jsonPath);
+        writeMacroJson(out, runs);
+        if (!out) {
+            std::cerr << "Cannot write " << jsonPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,255 @@
+// Micro-benchmarks for blending, rendering, fitness and the GA operators.
+// Usage: genetic_art_micro_bench [--filter TEXT] [--min-time S] [--repetitions N] [--quick] [--json FILE]
+#include "Benchmark.h"
+#include "BenchSupport.h"
+#include <fstream>
+#include <memory>
+
+static const char* shapeName(ShapeType s) { return s == ShapeType::Circle ? "circle" : "square"; }
+static const char* blendName(BlendMode m) {
+    return m == BlendMode::AlphaOver ? "alpha" : m == BlendMode::Additive ? "add" : "overwrite";
+}
+
+// GA over a procedural target with a small initialized and scored population, for timing single phases
+static std::shared_ptr<GeneticAlgorithm> makeGA(const Image& target, int population, GeneticAlgorithmOptions options = {}) {
+    BenchQuietCout quiet;
+    options.seed = 42;
+    options.snapshotEvery = 0;
+    return std::make_shared<GeneticAlgorithm>(population, 3, 1, target.width, target.height, target, 10, 32, 0, ShapeType::Circle,
+                                              BlendMode::AlphaOver, options);
+}
+
+static void addBlendCases(BenchRunner& runner) {
+    const std::pair<const char*, DrawBlendFn> blends[] = {
+        {"draw_blend_alpha_over", &draw_blend_alpha_over}, {"draw_blend_add", &draw_blend_add}, {"draw_blend_overwrite", &draw_blend_overwrite}};
+    for (const auto& blend : blends) {
+        runner.add(blend.first, {}, [fn = blend.second](BenchRunner::Counters&) -> BenchRunner::Body {
+            auto canvas = std::make_shared<PixelBuffer>(4096, Pixel32{10, 20, 30, 255});
+            return [fn, canvas](int64_t iterations) {
+                const Pixel32 src{200, 100, 50, 128};
+                for (int64_t i = 0; i < iterations; ++i) {
+                    Pixel32& dst = (*canvas)[static_cast<size_t>(i) & 4095];
+                    dst = fn(dst, src);
+                }
+                benchKeep((*canvas)[0]);
+            };
+        });
+    }
+}
+
+static void addRenderCases(BenchRunner& runner, bool quick) {
+    // Every shape and blend mode at one representative size
+    for (ShapeType shape : {ShapeType::Circle, ShapeType::Square}) {
+        for (BlendMode mode : {BlendMode::AlphaOver, BlendMode::Additive, BlendMode::Overwrite}) {
+            const int size = 256, genes = 200, length = 16;
+            runner.add(std::string("renderIndividualToPixels/") + shapeName(shape) + "/" + blendName(mode),
+                       {{"size", double(size)}, {"genes", double(genes)}, {"length", double(length)}},
+                       [=](BenchRunner::Counters&) -> BenchRunner::Body {
+                           Random rand(7);
+                           Individual individual = syntheticIndividual(rand, size, size, genes, length, shape);
+                           return [=](int64_t iterations) {
+                               for (int64_t i = 0; i < iterations; ++i) benchKeep(renderIndividualToPixels(size, size, individual, mode));
+                           };
+                       });
+        }
+    }
+    // Size, gene count and radius sweep for the default shape and blend, into a reused canvas
+    std::vector<int> sizes = quick ? std::vector<int>{64, 256} : std::vector<int>{64, 256, 1024};
+    for (int size : sizes) {
+        for (int genes : {50, 500}) {
+            for (int length : {4, 32}) {
+                runner.add("renderIndividualInto/circle/alpha", {{"size", double(size)}, {"genes", double(genes)}, {"length", double(length)}},
+                           [=](BenchRunner::Counters&) -> BenchRunner::Body {
+                               Random rand(7);
+                               Individual individual = syntheticIndividual(rand, size, size, genes, length, ShapeType::Circle);
+                               auto canvas = std::make_shared<PixelBuffer>();
+                               return [=](int64_t iterations) {
+                                   for (int64_t i = 0; i < iterations; ++i) {
+                                       renderIndividualInto(size, size, individual, BlendMode::AlphaOver, *canvas);
+                                       benchKeep((*canvas)[0]);
+                                   }
+                               };
+                           });
+                // The cost model walks the same rows without blending: what bounding a genome costs
+                runner.add("individualPixelCost", {{"size", double(size)}, {"genes", double(genes)}, {"length", double(length)}},
+                           [=](BenchRunner::Counters& counters) -> BenchRunner::Body {
+                               Random rand(7);
+                               Individual individual = syntheticIndividual(rand, size, size, genes, length, ShapeType::Circle);
+                               counters.push_back({"pixels", double(individualPixelCost(individual, size, size))});
+                               return [=](int64_t iterations) {
+                                   for (int64_t i = 0; i < iterations; ++i) benchKeep(individualPixelCost(individual, size, size));
+                               };
+                           });
+            }
+        }
+    }
+}
+
+static void addFitnessCases(BenchRunner& runner, bool quick) {
+    std::vector<int> sizes = quick ? std::vector<int>{64, 256} : std::vector<int>{64, 256, 1024};
+    for (int size : sizes) {
+        for (int genes : {50, 500}) {
+            runner.add("evaluateFitnessIndividual/exact", {{"size", double(size)}, {"genes", double(genes)}, {"length", 16}},
+                       [=](BenchRunner::Counters&) -> BenchRunner::Body {
+                           auto ga = makeGA(proceduralTarget(size, size), 2);
+                           Random rand(7);
+                           auto individual = std::make_shared<Individual>(syntheticIndividual(rand, size, size, genes, 16, ShapeType::Circle));
+                           return [=](int64_t iterations) {
+                               for (int64_t i = 0; i < iterations; ++i) {
+                                   GeneticAlgorithmBenchAccess::evaluate(*ga, *individual);
+                                   benchKeep(individual->fitness);
+                               }
+                           };
+                       });
+        }
+
+        // One gene mutated per evaluation: the error table repaints only the dirty rectangle
+        runner.add("evaluateFitnessIndividual/error-table-after-mutation", {{"size", double(size)}, {"genes", 500}, {"length", 16}},
+                   [=](BenchRunner::Counters&) -> BenchRunner::Body {
+                       GeneticAlgorithmOptions options;
+                       options.errorTables = true;
+                       auto ga = makeGA(proceduralTarget(size, size), 2, options);
+                       auto rand = std::make_shared<Random>(7);
+                       auto individual = std::make_shared<Individual>(syntheticIndividual(*rand, size, size, 500, 16, ShapeType::Circle));
+                       GeneticAlgorithmBenchAccess::evaluate(*ga, *individual);
+                       return [=](int64_t iterations) {
+                           for (int64_t i = 0; i < iterations; ++i) {
+                               individual->mutate_random_gene(*rand, size, size);
+                               GeneticAlgorithmBenchAccess::evaluate(*ga, *individual);
+                               benchKeep(individual->fitness);
+                           }
+                       };
+                   });
+    }
+
+    // Sampled estimates: time per evaluation, plus how far the estimate lands from the exact
+    // score and how wide its 95% interval is (mean over fresh sample sets, relative to exact)
+    for (int size : {256, 1024}) {
+        if (quick && size > 256) continue;
+        for (int samples : {256, 1024, 4096}) {
+            runner.add("evaluateFitnessIndividual/sampled", {{"size", double(size)}, {"genes", 500}, {"samples", double(samples)}},
+                       [=](BenchRunner::Counters& counters) -> BenchRunner::Body {
+                           Image target = proceduralTarget(size, size);
+                           Random rand(7);
+                           Individual individual = syntheticIndividual(rand, size, size, 500, 16, ShapeType::Circle);
+                           GeneticAlgorithmOptions options;
+                           options.fitnessSamples = samples;
+                           auto ga = makeGA(target, 2, options);
+
+                           Individual exact = individual;
+                           GeneticAlgorithmBenchAccess::evaluate(*makeGA(target, 2), exact);
+                           double relError = 0.0, interval = 0.0;
+                           const int draws = 20;
+                           for (int d = 0; d < draws; ++d) {
+                               GeneticAlgorithmBenchAccess::refreshSamples(*ga);
+                               GeneticAlgorithmBenchAccess::evaluate(*ga, individual);
+                               relError += std::abs(individual.fitness - exact.fitness) / exact.fitness / draws;
+                               interval += individual.fitnessInterval / exact.fitness / draws;
+                           }
+                           counters.push_back({"mean_relative_error", relError});
+                           counters.push_back({"mean_relative_ci95", interval});
+
+                           auto copy = std::make_shared<Individual>(individual);
+                           return [=](int64_t iterations) {
+                               for (int64_t i = 0; i < iterations; ++i) {
+                                   GeneticAlgorithmBenchAccess::evaluate(*ga, *copy);
+                                   benchKeep(copy->fitness);
+                               }
+                           };
+                       });
+        }
+    }
+}
+
+static void addOperatorCases(BenchRunner& runner) {
+    for (int population : {50, 200}) {
+        for (int size : {3, 8}) {
+            runner.add("tournamentSelection", {{"population", double(population)}, {"tournament", double(size)}},
+                       [=](BenchRunner::Counters&) -> BenchRunner::Body {
+                           auto ga = makeGA(proceduralTarget(64, 64), population);
+                           return [=](int64_t iterations) {
+                               for (int64_t i = 0; i < iterations; ++i) benchKeep(GeneticAlgorithmBenchAccess::tournament(*ga, size).fitness);
+                           };
+                       });
+        }
+    }
+    for (int genes : {50, 500, 5000}) {
+        runner.add("crossover", {{"genes", double(genes)}}, [=](BenchRunner::Counters&) -> BenchRunner::Body {
+            auto ga = makeGA(proceduralTarget(64, 64), 2);
+            Random rand(7);
+            Individual a = syntheticIndividual(rand, 64, 64, genes, 8, ShapeType::Circle);
+            Individual b = syntheticIndividual(rand, 64, 64, genes, 8, ShapeType::Circle);
+            return [=](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; ++i) benchKeep(GeneticAlgorithmBenchAccess::crossover(*ga, a, b).dna.size());
+            };
+        });
+        runner.add("Individual/copy", {{"genes", double(genes)}}, [=](BenchRunner::Counters&) -> BenchRunner::Body {
+            Random rand(7);
+            Individual a = syntheticIndividual(rand, 64, 64, genes, 8, ShapeType::Circle);
+            return [=](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; ++i) {
+                    Individual copy = a;
+                    benchKeep(copy.dna.size());
+                }
+            };
+        });
+        // A copy that then writes pays for cloning one chunk of the shared rope
+        runner.add("Individual/copy-then-mutate", {{"genes", double(genes)}}, [=](BenchRunner::Counters&) -> BenchRunner::Body {
+            auto rand = std::make_shared<Random>(7);
+            Individual a = syntheticIndividual(*rand, 64, 64, genes, 8, ShapeType::Circle);
+            return [=](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; ++i) {
+                    Individual copy = a;
+                    copy.mutate_random_gene(*rand, 64, 64);
+                    benchKeep(copy.dna.size());
+                }
+            };
+        });
+    }
+    runner.add("Random/getInt", {}, [](BenchRunner::Counters&) -> BenchRunner::Body {
+        auto rand = std::make_shared<Random>(7);
+        return [rand](int64_t iterations) {
+            int sum = 0;
+            for (int64_t i = 0; i < iterations; ++i) sum += rand->getInt(0, 1000);
+            benchKeep(sum);
+        };
+    });
+}
+
+int main(int argc, char** argv) {
+    BenchRunner runner;
+    bool quick = false;
+    std::string jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string { return i + 1 < argc ? argv[++i] : std::string(); };
+        if (arg == "--filter") runner.filter = value();
+        else if (arg == "--min-time") runner.minTime = std::stod(value());
+        else if (arg == "--repetitions") runner.repetitions = std::stoi(value());
+        else if (arg == "--quick") quick = true;
+        else if (arg == "--json") jsonPath = value();
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter TEXT] [--min-time S] [--repetitions N] [--quick] [--json FILE]" << std::endl;
+            return 2;
+        }
+    }
+
+    addBlendCases(runner);
+    addRenderCases(runner, quick);
+    addFitnessCases(runner, quick);
+    addOperatorCases(runner);
+
+    // Progress on stderr; JSON to the file, or to stdout when no file is given
+    std::vector<BenchResult> results = runner.run(std::cerr);
+    if (jsonPath.empty()) {
+        writeBenchJson(std::cout, "micro", results);
+    } else {
+        std::ofstream out(jsonPath);
+        writeBenchJson(out, "micro", results);
+        if (!out) {
+            std::cerr << "Cannot write " << jsonPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
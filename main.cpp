@@ -4,29 +4,515 @@
 #include "LoadImage.h"
 #include "GeneticAlgorithm.h"
 #include "Draw.h"
+#include "ThreadPool.h"
+#include "GenomeIO.h"
+#include "TargetCache.h"
+#include "TiledEvolution.h"
+#include "Islands.h"
+#include "RemoteEvaluation.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
 
+struct CliOptions {
+    int populationSize = 100;
+    int tournamentSize = 3;
+    int elitismCount = 1;
+    int minGenes = 100;
+    int maxGenes = 5000;
+    int generations = 10000;
+    ShapeType shape = ShapeType::Circle;
+    BlendMode blend = BlendMode::AlphaOver;
+    unsigned int threads = std::thread::hardware_concurrency();
+    bool preview = false;
+    bool resume = false;
+    std::vector<std::string> images;
+    std::vector<std::string> genomes; // --render-genome inputs
+    double renderScale = 1.0;
+    std::string targetCache; // --target-cache directory; empty = decode every run
+    int tileSize = 0;        // --tile; 0 = evolve the whole image at once
+    int tileOverlap = 32;
+    int islands = 1;          // --islands; sub-populations evolving on their own threads
+    std::string serve;                // --serve address; score genomes for other processes instead of evolving
+    std::vector<std::string> workers; // --workers; evaluation workers this run ships its genomes to
+    int batchSize = 16;               // genomes per request to a worker
+    int pipelineDepth = 2;            // requests in flight per worker
+    int profileEvery = 0;     // --profile-every; 0 = report once at exit
+    std::string profileTrace; // --profile-trace Chrome trace output; empty = none
+    GeneticAlgorithmOptions ga;
+};
 
-int main() {
-    std::cout << "Hello, Genetic Art!" << std::endl;
+static void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options] [image...]\n"
+              << "Evolves every image given on the command line or in the manifest (default ./pic.jpg).\n\n"
+              << "  --manifest FILE           read image paths from FILE, one per line ('#' starts a comment)\n"
+              << "  --population N            population size (100)\n"
+              << "  --tournament N            tournament size (3)\n"
+              << "  --elitism N               elites kept per generation (1)\n"
+              << "  --min-genes N             minimum initial genes (100)\n"
+              << "  --max-genes N             maximum initial genes (5000)\n"
+              << "  --min-length N            smallest radius/side of new genes (1)\n"
+              << "  --max-length N            largest radius/side of new or mutated genes (0 = quarter of the smaller side)\n"
+              << "  --generations N           generations per image (10000)\n"
+              << "  --shape circle|square     gene shape (circle)\n"
+              << "  --blend alpha|add|overwrite  compositing mode (alpha)\n"
+              << "  --pyramid-levels N        coarse levels for coarse-to-fine evolution (2)\n"
+              << "  --level-generations N     generations per coarse level (0 = half the run spread over the levels)\n"
+              << "  --stagnation N            also promote after N generations without improvement (200)\n"
+              << "  --samples N               estimate fitness on N sampled pixels (0 = exact)\n"
+              << "  --finalists N             extra candidates re-scored exactly before elitism (0)\n"
+              << "  --checkpoint-interval N   cache a prefix canvas every N genes (0 = off)\n"
+              << "  --error-tables            score children incrementally through error tables\n"
+              << "  --islands N               evolve N sub-populations in parallel, exchanging migrants (1)\n"
+              << "  --migration-interval N    generations between migrations (20)\n"
+              << "  --migrants N              best individuals each island sends per migration (2)\n"
+              << "  --topology ring|all|random  where migrants go (ring)\n"
+              << "  --workers ADDR[,ADDR...]  score generations on evaluation workers (host:port or unix:/path)\n"
+              << "  --batch N                 genomes per worker request (16)\n"
+              << "  --pipeline N              requests in flight per worker (2)\n"
+              << "  --serve ADDR              run as an evaluation worker for the one image given, until stopped\n"
+              << "  --steady-state            breed and insert children continuously on every thread (no generation barrier)\n"
+              << "  --hill-climb              optimize one genome with (1+lambda) hill climbing instead of a population\n"
+              << "  --candidates N            mutants tried per hill-climbing step (0 = one per thread)\n"
+              << "  --temperature T           initial annealing temperature in fitness units, cooled to 0 (0 = improvements only)\n"
+              << "  --adaptive-operators      pick mutation operators by measured improvement per pixel of scoring work\n"
+              << "  --pixel-budget N          cap the pixels an individual's genes may cover in total (0 = no bound)\n"
+              << "  --area-budget F           the same cap as F times the image area (0 = no bound)\n"
+              << "  --target-cache DIR        reuse decoded targets and pyramids mapped from DIR\n"
+              << "  --tile N                  evolve NxN tiles one at a time and stitch them (0 = whole image)\n"
+              << "  --tile-overlap N          pixels of neighbouring context each tile sees (32)\n"
+              << "  --output DIR              output directory (./images)\n"
+              << "  --snapshot-every N        generations between snapshots (100, 0 = none)\n"
+              << "  --format tga|png|ppm|pam  snapshot and result image format (tga)\n"
+              << "  --checkpoint-every N      save <output>/<stem>/checkpoint.gack every N generations (0 = off)\n"
+              << "  --resume                  continue from an existing checkpoint (or finished tiles) when there is one\n"
+              << "  --threads N               worker threads shared by all jobs (all cores)\n"
+              << "  --seed N                  random seed (non-deterministic)\n"
+              << "  --profile-every N         print phase timings every N generations (GENETICART_PROFILE builds)\n"
+              << "  --profile-trace FILE      write a Chrome trace of every timed phase at exit (GENETICART_PROFILE builds)\n"
+              << "  --preview                 show target and result windows (Windows builds)\n"
+              << "  --render-genome FILE      render the genomes saved in FILE instead of evolving\n"
+              << "  --scale S                 output scale for --render-genome (1.0)\n"
+              << "  --help                    show this message\n";
+}
+
+static bool readManifest(const std::string& path, std::vector<std::string>& images) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos) continue;
+        size_t last = line.find_last_not_of(" \t\r");
+        images.push_back(line.substr(first, last - first + 1));
+    }
+    return true;
+}
+
+// Returns false (after printing why) on a malformed command line
+static bool parseArgs(int argc, char** argv, CliOptions& cli, bool& helpRequested) {
+    cli.ga.pyramidLevels = 2;
+    cli.ga.stagnationGenerations = 200;
+    cli.ga.migrationInterval = 20;
+    cli.ga.migrants = 2;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+        auto intValue = [&]() { return std::stoi(value()); };
+
+        try {
+            if (arg == "--help" || arg == "-h") { helpRequested = true; return true; }
+            else if (arg == "--manifest") {
+                std::string path = value();
+                if (!readManifest(path, cli.images)) { std::cerr << "Cannot read manifest " << path << std::endl; return false; }
+            }
+            else if (arg == "--population") cli.populationSize = intValue();
+            else if (arg == "--tournament") cli.tournamentSize = intValue();
+            else if (arg == "--elitism") cli.elitismCount = intValue();
+            else if (arg == "--min-genes") cli.minGenes = intValue();
+            else if (arg == "--max-genes") cli.maxGenes = intValue();
+            else if (arg == "--generations") cli.generations = intValue();
+            else if (arg == "--shape") {
+                std::string v = value();
+                if (v == "circle") cli.shape = ShapeType::Circle;
+                else if (v == "square") cli.shape = ShapeType::Square;
+                else throw std::invalid_argument("unknown shape " + v);
+            }
+            else if (arg == "--blend") {
+                std::string v = value();
+                if (v == "alpha") cli.blend = BlendMode::AlphaOver;
+                else if (v == "add") cli.blend = BlendMode::Additive;
+                else if (v == "overwrite") cli.blend = BlendMode::Overwrite;
+                else throw std::invalid_argument("unknown blend mode " + v);
+            }
+            else if (arg == "--pyramid-levels") cli.ga.pyramidLevels = intValue();
+            else if (arg == "--level-generations") cli.ga.generationsPerLevel = intValue();
+            else if (arg == "--stagnation") cli.ga.stagnationGenerations = intValue();
+            else if (arg == "--samples") cli.ga.fitnessSamples = intValue();
+            else if (arg == "--finalists") cli.ga.exactFinalists = intValue();
+            else if (arg == "--checkpoint-interval") cli.ga.checkpointInterval = intValue();
+            else if (arg == "--error-tables") cli.ga.errorTables = true;
+            else if (arg == "--steady-state") cli.ga.steadyState = true;
+            else if (arg == "--hill-climb") cli.ga.hillClimb = true;
+            else if (arg == "--adaptive-operators") cli.ga.adaptiveOperators = true;
+            else if (arg == "--candidates") cli.ga.climbCandidates = intValue();
+            else if (arg == "--temperature") cli.ga.temperature = std::stod(value());
+            else if (arg == "--islands") cli.islands = intValue();
+            else if (arg == "--serve") cli.serve = value();
+            else if (arg == "--workers") {
+                std::stringstream list(value());
+                std::string address;
+                while (std::getline(list, address, ',')) {
+                    if (!address.empty()) cli.workers.push_back(address);
+                }
+            }
+            else if (arg == "--batch") cli.batchSize = intValue();
+            else if (arg == "--pipeline") cli.pipelineDepth = intValue();
+            else if (arg == "--migration-interval") cli.ga.migrationInterval = intValue();
+            else if (arg == "--migrants") cli.ga.migrants = intValue();
+            else if (arg == "--topology") {
+                std::string t = value();
+                if (t == "ring") cli.ga.topology = MigrationTopology::Ring;
+                else if (t == "all") cli.ga.topology = MigrationTopology::All;
+                else if (t == "random") cli.ga.topology = MigrationTopology::Random;
+                else throw std::invalid_argument("unknown topology " + t);
+            }
+            else if (arg == "--pixel-budget") cli.ga.pixelBudget = std::stoull(value());
+            else if (arg == "--area-budget") cli.ga.areaBudget = std::stod(value());
+            else if (arg == "--min-length") cli.ga.minGeneLength = intValue();
+            else if (arg == "--max-length") cli.ga.maxGeneLength = intValue();
+            else if (arg == "--target-cache") cli.targetCache = value();
+            else if (arg == "--tile") cli.tileSize = intValue();
+            else if (arg == "--tile-overlap") cli.tileOverlap = intValue();
+            else if (arg == "--output") cli.ga.outputDirectory = value();
+            else if (arg == "--snapshot-every") cli.ga.snapshotEvery = intValue();
+            else if (arg == "--format") {
+                std::string v = value();
+                if (v != "tga" && v != "png" && v != "ppm" && v != "pam") throw std::invalid_argument("unknown format " + v);
+                cli.ga.snapshotFormat = v;
+            }
+            else if (arg == "--checkpoint-every") cli.ga.checkpointEvery = intValue();
+            else if (arg == "--resume") cli.resume = true;
+            else if (arg == "--threads") cli.threads = static_cast<unsigned int>(intValue());
+            else if (arg == "--seed") cli.ga.seed = static_cast<unsigned int>(std::stoul(value()));
+            else if (arg == "--profile-every") cli.profileEvery = intValue();
+            else if (arg == "--profile-trace") cli.profileTrace = value();
+            else if (arg == "--preview") cli.preview = true;
+            else if (arg == "--render-genome") cli.genomes.push_back(value());
+            else if (arg == "--scale") cli.renderScale = std::stod(value());
+            else if (!arg.empty() && arg[0] == '-') throw std::invalid_argument("unknown option " + arg);
+            else cli.images.push_back(arg);
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid arguments: " << e.what() << std::endl;
+            return false;
+        }
+    }
 
-    // Load an image
-    Image img = loadImage("./pic.jpg");
+    if (cli.populationSize < 1 || cli.tournamentSize < 1 || cli.elitismCount < 0 || cli.elitismCount >= cli.populationSize
+        || cli.minGenes < 0 || cli.maxGenes < std::max(1, cli.minGenes) || cli.generations < 0 || !(cli.renderScale > 0.0)
+        || cli.tileSize < 0 || cli.tileOverlap < 0 || cli.ga.minGeneLength < 1 || cli.ga.maxGeneLength < 0 || cli.ga.areaBudget < 0.0
+        || cli.islands < 1 || cli.ga.migrationInterval < 0 || cli.ga.migrants < 0 || cli.batchSize < 1 || cli.pipelineDepth < 1
+        || cli.ga.climbCandidates < 0 || !(cli.ga.temperature >= 0.0)) {
+        std::cerr << "Invalid arguments: check population, tournament, elitism, gene and tile bounds" << std::endl;
+        return false;
+    }
+    if (cli.tileSize > 0 && cli.ga.snapshotFormat == "png") {
+        std::cerr << "Invalid arguments: tiled output is streamed, use --format tga, ppm or pam" << std::endl;
+        return false;
+    }
+    if (cli.islands > 1 && cli.tileSize > 0) {
+        std::cerr << "Invalid arguments: --islands and --tile cannot be combined" << std::endl;
+        return false;
+    }
+    if (cli.ga.steadyState && cli.ga.hillClimb) {
+        std::cerr << "Invalid arguments: choose one of --steady-state and --hill-climb" << std::endl;
+        return false;
+    }
+    if (!cli.workers.empty() && (cli.tileSize > 0 || cli.ga.steadyState || cli.ga.hillClimb || cli.ga.errorTables || cli.ga.fitnessSamples > 0)) {
+        std::cerr << "Invalid arguments: --workers scores whole generations exactly; drop --tile, --steady-state, --hill-climb, --error-tables and --samples" << std::endl;
+        return false;
+    }
+    if (cli.images.empty() && cli.genomes.empty()) cli.images.push_back("./pic.jpg");
+    if (!cli.serve.empty() && (cli.images.size() != 1 || !cli.genomes.empty())) {
+        std::cerr << "Invalid arguments: --serve needs exactly one target image" << std::endl;
+        return false;
+    }
+    if ((cli.profileEvery > 0 || !cli.profileTrace.empty()) && !PROFILE_ENABLED) {
+        std::cerr << "Warning: built without GENETICART_PROFILE, phase timings are not recorded" << std::endl;
+    }
+    if (cli.profileEvery > 0 && (cli.ga.steadyState || cli.islands > 1)) {
+        // Steady-state workers and other islands keep timing while onGeneration runs
+        std::cerr << "Invalid arguments: --profile-every needs generation barriers; drop --steady-state and --islands (the report at exit still covers them)" << std::endl;
+        return false;
+    }
+    if (cli.profileEvery > 0) {
+        // Generational and hill-climbing engines call onGeneration after parallelFor has returned,
+        // so no other thread is timing and every thread's data can be read
+        const int every = cli.profileEvery;
+        cli.ga.onGeneration = [every](int generation, const Individual&) {
+            if (generation % every == 0) profileReport(std::cerr);
+        };
+    }
+    return true;
+}
+
+// Every parameter that decides a tile's result; finished tiles are reused only under the same text
+static std::string tileRunKey(const CliOptions& cli) {
+    const GeneticAlgorithmOptions& ga = cli.ga;
+    std::ostringstream key;
+    key.precision(17);
+    key << "tile " << cli.tileSize << " overlap " << cli.tileOverlap << " population " << cli.populationSize << " tournament "
+        << cli.tournamentSize << " elitism " << cli.elitismCount << " genes " << cli.minGenes << "-" << cli.maxGenes << " generations "
+        << cli.generations << " shape " << static_cast<int>(cli.shape) << " blend " << static_cast<int>(cli.blend) << " seed " << ga.seed
+        << " pyramid " << ga.pyramidLevels << "/" << ga.generationsPerLevel << "/" << ga.stagnationGenerations << " samples "
+        << ga.fitnessSamples << "/" << ga.exactFinalists << " error-tables " << ga.errorTables << " budget " << ga.pixelBudget << "/"
+        << ga.areaBudget << " length " << ga.minGeneLength << "-" << ga.maxGeneLength << " steady-state " << ga.steadyState
+        << " hill-climb " << ga.hillClimb << "/" << ga.climbCandidates << "/" << ga.temperature << " adaptive " << ga.adaptiveOperators << "\n";
+    return key.str();
+}
+
+// Tiled variant of runJob: tiles are evolved one at a time under <output>/<stem>/tiles/, and the
+// stitched result is rendered band by band, so neither the target nor the output is held whole
+static bool runTiledJob(const CliOptions& cli, const std::string& path, ThreadPool& pool) {
+    namespace fs = std::filesystem;
+    const std::string stem = fs::path(path).stem().string();
+    const fs::path jobDir = fs::path(cli.ga.outputDirectory) / stem;
+    try {
+        auto source = openTileSource(path, [&](const std::string& p) {
+            return cli.targetCache.empty() ? loadImage(p) : Image(loadTargetPyramid(p, cli.targetCache)[0]);
+        });
+        const int width = source->width(), height = source->height();
+        if (cli.ga.snapshotFormat == "tga" && (width > TGA_MAX_DIMENSION || height > TGA_MAX_DIMENSION)) {
+            // Checked before any tile is evolved rather than when the stitched result is written
+            std::cerr << path << ": " << width << "x" << height << " exceeds the TGA limit of " << TGA_MAX_DIMENSION
+                      << " pixels per side, use --format pam or ppm" << std::endl;
+            return false;
+        }
+        std::cout << "Evolving " << path << " (" << width << "x" << height << ") in " << cli.tileSize << "px tiles" << std::endl;
+
+        TiledOptions tiled;
+        tiled.tileSize = cli.tileSize;
+        tiled.overlap = cli.tileOverlap;
+        tiled.mode = cli.blend;
+        tiled.tileDir = (jobDir / "tiles").string();
+        tiled.resume = cli.resume;
+        tiled.runKey = tileRunKey(cli);
+        std::vector<TilePiece> pieces = evolveTiled(*source, tiled, [&](const Image& tile, size_t index) {
+            GeneticAlgorithmOptions options = cli.ga;
+            options.outputDirectory = (jobDir / ("tile" + std::to_string(index))).string();
+            options.pool = &pool;
+            options.checkpointPath.clear(); // finished tiles are the resume points
+            std::error_code ec;
+            if (options.snapshotEvery > 0) fs::create_directories(options.outputDirectory, ec);
+            std::cout << "Tile " << index << " (" << tile.width << "x" << tile.height << ")" << std::endl;
+            GeneticAlgorithm ga(cli.populationSize, cli.tournamentSize, cli.elitismCount, tile.width, tile.height, tile,
+                                cli.minGenes, cli.maxGenes, cli.generations, cli.shape, cli.blend, options);
+            return ga.BestIndividual();
+        });
+
+        const std::string resultPath = (fs::path(cli.ga.outputDirectory) / (stem + "." + cli.ga.snapshotFormat)).string();
+        if (!saveTilesStreamed(resultPath, width, height, pieces, cli.blend)) {
+            std::cerr << resultPath << ": failed to write" << std::endl;
+            return false;
+        }
+        std::cout << "Wrote " << resultPath << std::endl;
+        const Individual stitched = stitchTiles(pieces);
+        const fs::path base = fs::path(cli.ga.outputDirectory) / stem;
+        if (!saveGenome(base.string() + ".gad", stitched, width, height, cli.blend)
+            || !saveIndividualSVG(base.string() + ".svg", stitched, width, height, cli.blend)) {
+            std::cerr << base.string() << ": failed to save genome" << std::endl;
+            return false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    int width = img.width;
-    int height = img.height;
+// Evolves one image; snapshots go to <output>/<stem>/, the final render to <output>/<stem>.<format>
+// and the best genome to <output>/<stem>.gad and <output>/<stem>.svg
+static bool runJob(const CliOptions& cli, const std::string& path, ThreadPool& pool) {
+    Image img;
+    std::vector<PyramidLevel> levels;
+    try {
+        if (!cli.targetCache.empty()) {
+            levels = loadTargetPyramid(path, cli.targetCache);
+            img = levels[0];
+        } else {
+            img = loadImage(path);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << path << ": " << e.what() << std::endl;
+        return false;
+    }
 
-    // Render original
-    auto originalPixels = imageToPixels(img);
-    drawPixels(width, height, originalPixels, "", true);
+    namespace fs = std::filesystem;
+    const std::string stem = fs::path(path).stem().string();
+    GeneticAlgorithmOptions options = cli.ga;
+    options.outputDirectory = (fs::path(cli.ga.outputDirectory) / stem).string();
+    options.pool = &pool;
+    options.pyramid = levels.empty() ? nullptr : &levels;
+    options.checkpointPath = (fs::path(options.outputDirectory) / "checkpoint.gack").string();
+    std::error_code ec;
+    fs::create_directories(options.outputDirectory, ec);
+    if (ec) {
+        std::cerr << options.outputDirectory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<RemoteEvaluator> remote;
+    if (!cli.workers.empty()) {
+        try {
+            remote = std::make_unique<RemoteEvaluator>(cli.workers, img, options.pyramidLevels, cli.blend, cli.batchSize, cli.pipelineDepth);
+        } catch (const std::exception& e) {
+            std::cerr << path << ": " << e.what() << std::endl;
+            return false;
+        }
+        options.remote = remote.get();
+    }
+
+    std::cout << "Evolving " << path << " (" << img.width << "x" << img.height << ")" << std::endl;
+    if (cli.preview) drawImage(img, "", true);
+
+    auto evolve = [&](const GeneticAlgorithmOptions& gaOptions) {
+        if (cli.resume && fs::exists(gaOptions.checkpointPath)) {
+            GeneticAlgorithm ga(gaOptions.checkpointPath, img, gaOptions);
+            return ga.BestIndividual();
+        }
+        GeneticAlgorithm ga(cli.populationSize, cli.tournamentSize, cli.elitismCount, img.width, img.height, img,
+                            cli.minGenes, cli.maxGenes, cli.generations, cli.shape, cli.blend, gaOptions);
+        return ga.BestIndividual();
+    };
+
+    Individual bestIndividual;
+    try {
+        if (cli.islands > 1) {
+            // Each island snapshots and checkpoints under <output>/<stem>/island<i>/
+            bestIndividual = evolveIslands(cli.islands, cli.threads, options, [&](int island, GeneticAlgorithmOptions islandOptions) {
+                islandOptions.outputDirectory = (fs::path(options.outputDirectory) / ("island" + std::to_string(island))).string();
+                islandOptions.checkpointPath = (fs::path(islandOptions.outputDirectory) / "checkpoint.gack").string();
+                std::error_code dirError;
+                fs::create_directories(islandOptions.outputDirectory, dirError);
+                return evolve(islandOptions);
+            });
+        } else {
+            bestIndividual = evolve(options);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << path << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    auto pixels = renderIndividualToPixels(img.width, img.height, bestIndividual, cli.blend);
+    const std::string resultPath = (fs::path(cli.ga.outputDirectory) / (stem + "." + cli.ga.snapshotFormat)).string();
+    if (!drawPixels(img.width, img.height, pixels, resultPath, cli.preview)) {
+        std::cerr << resultPath << ": failed to write image" << std::endl;
+        return false;
+    }
+    std::cout << "Wrote " << resultPath << std::endl;
+
+    const fs::path base = fs::path(cli.ga.outputDirectory) / stem;
+    if (!saveGenome(base.string() + ".gad", bestIndividual, img.width, img.height, cli.blend)
+        || !saveIndividualSVG(base.string() + ".svg", bestIndividual, img.width, img.height, cli.blend)) {
+        std::cerr << base.string() << ": failed to save genome" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Re-renders saved genomes at any resolution without running the GA
+static bool renderGenomeFile(const CliOptions& cli, const std::string& path) {
+    namespace fs = std::filesystem;
+    std::vector<Genome> genomes = loadGenomes(path);
+    if (genomes.empty()) {
+        std::cerr << path << ": no genomes found" << std::endl;
+        return false;
+    }
+    std::error_code ec;
+    fs::create_directories(cli.ga.outputDirectory, ec);
+    const std::string stem = fs::path(path).stem().string();
+    for (size_t i = 0; i < genomes.size(); ++i) {
+        const Genome& g = genomes[i];
+        int width = std::max(1, static_cast<int>(g.width * cli.renderScale));
+        int height = std::max(1, static_cast<int>(g.height * cli.renderScale));
+        auto pixels = renderIndividualToPixels(width, height, g.individual, g.mode, cli.renderScale);
+        std::string name = genomes.size() == 1 ? stem : stem + "_" + std::to_string(i);
+        std::string out = (fs::path(cli.ga.outputDirectory) / (name + "." + cli.ga.snapshotFormat)).string();
+        if (!drawPixels(width, height, pixels, out, cli.preview)) {
+            std::cerr << out << ": failed to write image" << std::endl;
+            return false;
+        }
+        std::cout << "Wrote " << out << " (" << width << "x" << height << ")" << std::endl;
+    }
+    return true;
+}
+
+// Evaluation worker: scores genomes for coordinators started with --workers until the process is stopped
+static bool serveWorker(const CliOptions& cli, const std::string& path, ThreadPool& pool) {
+    Image img;
+    try {
+        img = cli.targetCache.empty() ? loadImage(path) : Image(loadTargetPyramid(path, cli.targetCache)[0]);
+    } catch (const std::exception& e) {
+        std::cerr << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    std::cout << "Serving evaluations of " << path << " (" << img.width << "x" << img.height << ") on " << cli.serve << std::endl;
+    std::string error;
+    if (!serveEvaluations(cli.serve, img, pool, error)) {
+        std::cerr << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "Hello, Genetic Art!" << std::endl;
 
-    GeneticAlgorithm ga(100, 3, 1, width, height, originalPixels, 100, 5000, 10000, ShapeType::Circle, BlendMode::AlphaOver);
-    Individual bestIndividual = ga.BestIndividual();
+    CliOptions cli;
+    bool helpRequested = false;
+    if (!parseArgs(argc, argv, cli, helpRequested)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (helpRequested) {
+        printUsage(argv[0]);
+        return 0;
+    }
 
-    // Render and show the best individual using free functions
-    auto pixels = renderIndividualToPixels(width, height, bestIndividual, BlendMode::AlphaOver);
-    drawPixels(width, height, pixels, "", true);
+    // One pool for every job, so worker threads and their scratch canvases are reused
+    ThreadPool pool(cli.threads);
 
-    
+    if (!cli.serve.empty()) {
+        return serveWorker(cli, cli.images[0], pool) ? 0 : 1;
+    }
 
+    int failed = 0;
+    for (const auto& path : cli.genomes) {
+        if (!renderGenomeFile(cli, path)) ++failed;
+    }
+    for (const auto& path : cli.images) {
+        bool ok = cli.tileSize > 0 ? runTiledJob(cli, path, pool) : runJob(cli, path, pool);
+        if (!ok) ++failed;
+    }
+    if (PROFILE_ENABLED) {
+        profileReport(std::cerr);
+        if (!cli.profileTrace.empty() && !profileWriteChromeTrace(cli.profileTrace)) {
+            std::cerr << "Cannot write " << cli.profileTrace << std::endl;
+        }
+    }
+    if (failed > 0) {
+        std::cerr << failed << " of " << cli.images.size() + cli.genomes.size() << " jobs failed" << std::endl;
+        return 1;
+    }
     return 0;
 }